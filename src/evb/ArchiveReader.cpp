@@ -0,0 +1,232 @@
+/*
+	ArchiveReader.cpp
+	Reads the CoMPASS binaries straight out of a run_N.tar.gz archive, in process. The archive is
+	decompressed with zlib and the tar stream is walked member by member; the contents of each requested
+	member are kept in memory and handed to CompassFile, so nothing is extracted to disk. A tar.gz is a
+	single sequential stream, so every member must be decompressed before the first hit can be merged;
+	the whole (uncompressed) run is therefore held in memory.
+*/
+#include "EventBuilder.h"
+#include "ArchiveReader.h"
+#include <zlib.h>
+#include <cstring>
+#include <cstdlib>
+#include <new>
+
+namespace EventBuilder {
+
+	namespace {
+
+		constexpr std::size_t s_blockSize = 512; //tar works in 512 byte blocks
+		constexpr uint64_t s_maxHeaderSize = 1 << 20; //long name and pax headers; anything larger is corrupt
+		constexpr uint64_t s_maxMemberSize = uint64_t(1) << 40; //members; anything larger is corrupt
+
+		/*gzread takes an unsigned int length, so large members are read in pieces*/
+		bool ReadBytes(gzFile file, char* data, uint64_t nbytes)
+		{
+			constexpr uint64_t chunk = 1 << 30;
+			while(nbytes > 0)
+			{
+				unsigned int length = nbytes > chunk ? chunk : nbytes;
+				int nread = gzread(file, data, length);
+				if(nread <= 0)
+					return false;
+				data += nread;
+				nbytes -= nread;
+			}
+			return true;
+		}
+
+		bool SkipBytes(gzFile file, uint64_t nbytes)
+		{
+			char block[s_blockSize];
+			while(nbytes > 0)
+			{
+				uint64_t length = nbytes > s_blockSize ? s_blockSize : nbytes;
+				if(!ReadBytes(file, block, length))
+					return false;
+				nbytes -= length;
+			}
+			return true;
+		}
+
+		inline uint64_t PaddedSize(uint64_t size) { return ((size + s_blockSize - 1)/s_blockSize)*s_blockSize; }
+
+		/*Sizes are octal text, or big-endian base-256 (high bit set) for members over 8 GB*/
+		uint64_t ParseSize(const char* field, std::size_t length)
+		{
+			uint64_t size = 0;
+			if(field[0] & 0x80)
+			{
+				for(std::size_t i=1; i<length; i++)
+					size = (size << 8) | (unsigned char) field[i];
+				return size;
+			}
+			for(std::size_t i=0; i<length && field[i] != '\0'; i++)
+			{
+				if(field[i] >= '0' && field[i] <= '7')
+					size = (size << 3) | (field[i] - '0');
+			}
+			return size;
+		}
+
+		std::string ParseString(const char* field, std::size_t length)
+		{
+			return std::string(field, strnlen(field, length));
+		}
+
+		/*
+			Extract the path record from a pax extended header ("<len> path=<name>\n" records, len counting the whole
+			record). path is left empty if there is no path record. Returns false for a malformed header.
+		*/
+		bool ParsePaxPath(const std::vector<char>& data, std::string& path)
+		{
+			path.clear();
+			std::size_t pos = 0;
+			while(pos < data.size())
+			{
+				std::size_t space = pos;
+				while(space < data.size() && data[space] != ' ')
+					space++;
+				if(space == data.size())
+					return false;
+				std::string lengthText(data.data() + pos, space - pos);
+				char* end = nullptr;
+				unsigned long long length = std::strtoull(lengthText.c_str(), &end, 10);
+				if(lengthText.empty() || end != lengthText.c_str() + lengthText.size() || length < space - pos + 2 || length > data.size() - pos)
+					return false;
+				std::string record(data.data() + space + 1, pos + length - space - 2); //drop trailing newline
+				if(record.compare(0, 5, "path=") == 0)
+				{
+					path = record.substr(5);
+					return true;
+				}
+				pos += length;
+			}
+			return true;
+		}
+	}
+
+	ArchiveReader::ArchiveReader() :
+		m_filename("")
+	{
+	}
+
+	ArchiveReader::ArchiveReader(const std::string& filename) :
+		m_filename(filename)
+	{
+	}
+
+	ArchiveReader::~ArchiveReader() {}
+
+	/*
+		Decompress the archive and keep every regular member whose name ends in suffix. Returns false if
+		the archive cannot be opened or is truncated/corrupt.
+	*/
+	bool ArchiveReader::ReadMembers(const std::string& suffix, std::vector<ArchiveMember>& members)
+	{
+		members.clear();
+		gzFile file = gzopen(m_filename.c_str(), "rb");
+		if(file == nullptr)
+		{
+			EVB_ERROR("Unable to open archive {0} at ArchiveReader::ReadMembers()!", m_filename);
+			return false;
+		}
+		gzbuffer(file, 1 << 20);
+
+		char header[s_blockSize];
+		std::string longName; //set by a GNU long name or pax header, applies to the next member
+		bool status = true;
+		while(true)
+		{
+			if(!ReadBytes(file, header, s_blockSize))
+			{
+				status = false;
+				break;
+			}
+			if(header[0] == '\0') //end of archive is marked by empty blocks
+				break;
+
+			uint64_t size = ParseSize(header + 124, 12);
+			char type = header[156];
+			std::string name = longName;
+			longName.clear();
+			if(name.empty())
+			{
+				name = ParseString(header, 100);
+				if(std::strncmp(header + 257, "ustar", 5) == 0 && header[345] != '\0')
+					name = ParseString(header + 345, 155) + "/" + name;
+			}
+
+			if(type == 'L' || type == 'x')
+			{
+				if(size > s_maxHeaderSize)
+				{
+					status = false;
+					break;
+				}
+				std::vector<char> data(PaddedSize(size));
+				if(!ReadBytes(file, data.data(), data.size()))
+				{
+					status = false;
+					break;
+				}
+				data.resize(size);
+				if(type == 'L')
+					longName = ParseString(data.data(), data.size());
+				else if(!ParsePaxPath(data, longName))
+				{
+					status = false;
+					break;
+				}
+				continue;
+			}
+			else if(size > s_maxMemberSize)
+			{
+				status = false;
+				break;
+			}
+
+			std::size_t slash = name.find_last_of('/');
+			if(slash != std::string::npos)
+				name = name.substr(slash + 1);
+
+			bool wanted = (type == '0' || type == '\0') && name.size() >= suffix.size() &&
+						  name.compare(name.size() - suffix.size(), suffix.size(), suffix) == 0;
+			if(!wanted)
+			{
+				if(!SkipBytes(file, PaddedSize(size)))
+				{
+					status = false;
+					break;
+				}
+				continue;
+			}
+
+			ArchiveMember member;
+			member.name = name;
+			member.size = size;
+			char* data = new(std::nothrow) char[size > 0 ? size : 1];
+			if(data == nullptr)
+			{
+				EVB_ERROR("Unable to allocate {0} bytes for member {1} of archive {2} at ArchiveReader::ReadMembers()!", size, name, m_filename);
+				status = false;
+				break;
+			}
+			std::shared_ptr<char> buffer(data, std::default_delete<char[]>());
+			if(!ReadBytes(file, buffer.get(), size) || !SkipBytes(file, PaddedSize(size) - size))
+			{
+				status = false;
+				break;
+			}
+			member.data = buffer;
+			members.push_back(member);
+		}
+
+		gzclose(file);
+		if(!status)
+			EVB_ERROR("Archive {0} is truncated or corrupt at ArchiveReader::ReadMembers()!", m_filename);
+		return status;
+	}
+
+}
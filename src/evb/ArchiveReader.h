@@ -0,0 +1,39 @@
+/*
+	ArchiveReader.h
+	Reads the CoMPASS binaries straight out of a run_N.tar.gz archive, in process. The archive is
+	decompressed with zlib and the tar stream is walked member by member; the contents of each requested
+	member are kept in memory and handed to CompassFile, so nothing is extracted to disk. A tar.gz is a
+	single sequential stream, so every member must be decompressed before the first hit can be merged;
+	the whole (uncompressed) run is therefore held in memory.
+*/
+#ifndef ARCHIVEREADER_H
+#define ARCHIVEREADER_H
+
+#include <memory>
+
+namespace EventBuilder {
+
+	struct ArchiveMember
+	{
+		std::string name; //name of the member within the archive, without any leading directories
+		std::shared_ptr<const char> data;
+		uint64_t size = 0;
+	};
+
+	class ArchiveReader
+	{
+	public:
+		ArchiveReader();
+		ArchiveReader(const std::string& filename);
+		~ArchiveReader();
+		inline void SetFile(const std::string& filename) { m_filename = filename; }
+		inline std::string GetFilename() const { return m_filename; }
+		bool ReadMembers(const std::string& suffix, std::vector<ArchiveMember>& members);
+
+	private:
+		std::string m_filename;
+	};
+
+}
+
+#endif
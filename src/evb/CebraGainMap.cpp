@@ -49,4 +49,17 @@ namespace EventBuilder {
     m_validFlag = true;
     return m_validFlag;
   }
+
+  /*Lookups never insert, so a filled map can be read by several plotting threads at once. Missing entries read as zero.*/
+  const GainShift& CebraGainMap::GetShift(int run, int range) const
+  {
+    static const GainShift none = {};
+    auto runEntry = m_map.find(run);
+    if(runEntry == m_map.end())
+      return none;
+    auto rangeEntry = runEntry->second.find(range);
+    if(rangeEntry == runEntry->second.end())
+      return none;
+    return rangeEntry->second;
+  }
 }
@@ -27,17 +27,19 @@ namespace EventBuilder {
     CebraGainMap(const std::string& filename);
     ~CebraGainMap();
     bool FillMap(const std::string& filename);
-    float GetT1(int run, int range){ return m_map[run][range].t1; }
-    float GetT2(int run, int range){ return m_map[run][range].t2; }
-    float GetSlope(int run, int range, int det){
-      return m_map[run][range].m[det];
+    float GetT1(int run, int range) const { return GetShift(run, range).t1; }
+    float GetT2(int run, int range) const { return GetShift(run, range).t2; }
+    float GetSlope(int run, int range, int det) const {
+      return GetShift(run, range).m[det];
     }
-    float GetIntercept(int run, int range, int det){
-      return m_map[run][range].b[det];
+    float GetIntercept(int run, int range, int det) const {
+      return GetShift(run, range).b[det];
     }
-    inline bool IsValid() { return m_validFlag; };
+    inline bool IsValid() const { return m_validFlag; };
   
   private:
+    const GainShift& GetShift(int run, int range) const;
+
     std::unordered_map<int, std::unordered_map< int, GainShift> > m_map;
     bool m_validFlag;
   };
@@ -11,6 +11,23 @@
 
 namespace EventBuilder {
 
+	DetAttribute GetFocalPlaneAttribute(const std::string& partname)
+	{
+		if(partname == "SCINTRIGHT") return DetAttribute::ScintRight;
+		else if(partname == "SCINTLEFT") return DetAttribute::ScintLeft;
+		else if(partname == "DELAYFR") return DetAttribute::DelayFR;
+		else if(partname == "DELAYFL") return DetAttribute::DelayFL;
+		else if(partname == "DELAYBR") return DetAttribute::DelayBR;
+		else if(partname == "DELAYBL") return DetAttribute::DelayBL;
+		else if(partname == "CATHODE") return DetAttribute::Cathode;
+		else if(partname == "ANODEFRONT") return DetAttribute::AnodeFront;
+		else if(partname == "ANODEBACK") return DetAttribute::AnodeBack;
+		else if(partname == "MONITOR") return DetAttribute::Monitor;
+
+		else if(partname == "SCINTLEFTCOPY") return DetAttribute::ScintLeftCopy;
+		return DetAttribute::NoneAttr;
+	}
+
 	ChannelMap::ChannelMap() :
 		m_validFlag(false)
 	{
@@ -93,18 +110,7 @@ namespace EventBuilder {
 			{
 				this_chan.type = DetType::FocalPlane;
 				this_chan.local_channel = id;
-				if(partname == "SCINTRIGHT") this_chan.attribute = DetAttribute::ScintRight;
-				else if(partname == "SCINTLEFT") this_chan.attribute = DetAttribute::ScintLeft;
-				else if(partname == "DELAYFR") this_chan.attribute = DetAttribute::DelayFR;
-				else if(partname == "DELAYFL") this_chan.attribute = DetAttribute::DelayFL;
-				else if(partname == "DELAYBR") this_chan.attribute = DetAttribute::DelayBR;
-				else if(partname == "DELAYBL") this_chan.attribute = DetAttribute::DelayBL;
-				else if(partname == "CATHODE") this_chan.attribute = DetAttribute::Cathode;
-				else if(partname == "ANODEFRONT") this_chan.attribute = DetAttribute::AnodeFront;
-				else if(partname == "ANODEBACK") this_chan.attribute = DetAttribute::AnodeBack;
-				else if(partname == "MONITOR") this_chan.attribute = DetAttribute::Monitor;
-
-				else if(partname == "SCINTLEFTCOPY") this_chan.attribute = DetAttribute::ScintLeftCopy;
+				this_chan.attribute = GetFocalPlaneAttribute(partname);
 			}
 	
 			m_cmap[gchan] = this_chan;
@@ -59,6 +59,9 @@ namespace EventBuilder {
 		int local_channel; //Which specific piece of detector we're looking at
 	};
 	
+	//Attribute of a focal plane part, by its name in the channel map file (i.e. SCINTLEFT); NoneAttr if unknown
+	DetAttribute GetFocalPlaneAttribute(const std::string& partname);
+
 	class ChannelMap 
 	{
 		
@@ -0,0 +1,63 @@
+/*
+	ChannelTable.cpp
+	Dense routing table over global compass channels (board#*16 + channel), built once from the ShiftMap and
+	the ChannelMap. Each entry holds everything the per-hit path needs to know about a channel: the timestamp
+	shift applied at decode, and the detector type and attribute used by SlowSort to pick the destination
+	vector of the hit. Lookups are a bounds checked array index, so no hashing is done per hit. Channels
+	outside the table are treated as unshifted and unmapped.
+*/
+#include "EventBuilder.h"
+#include "ChannelTable.h"
+
+namespace EventBuilder {
+
+	ChannelTable::ChannelTable() {}
+
+	ChannelTable::~ChannelTable() {}
+
+	/*Replace the shifts of every channel; an invalid ShiftMap leaves all shifts at 0*/
+	void ChannelTable::SetShifts(ShiftMap& smap)
+	{
+		for(auto& route : m_routes)
+			route.shift = 0;
+		if(!smap.IsValid())
+			return;
+
+		for(auto& entry : *smap.GetSMap())
+		{
+			if(entry.first >= 0)
+				Route(entry.first).shift = entry.second;
+		}
+	}
+
+	/*Replace the detector assignments of every channel; an invalid ChannelMap leaves all channels unmapped*/
+	void ChannelTable::SetChannels(ChannelMap& cmap)
+	{
+		for(auto& route : m_routes)
+		{
+			route.mapped = false;
+			route.type = DetType::NoneType;
+			route.attribute = DetAttribute::NoneAttr;
+		}
+		if(!cmap.IsValid())
+			return;
+
+		for(auto& entry : *cmap.GetCMap())
+		{
+			if(entry.first < 0)
+				continue;
+			ChannelRoute& route = Route(entry.first);
+			route.mapped = true;
+			route.type = entry.second.type;
+			route.attribute = entry.second.attribute;
+		}
+	}
+
+	ChannelRoute& ChannelTable::Route(int gchan)
+	{
+		if(gchan >= int(m_routes.size()))
+			m_routes.resize(gchan + 1);
+		return m_routes[gchan];
+	}
+
+}
@@ -0,0 +1,45 @@
+/*
+	ChannelTable.h
+	Dense routing table over global compass channels (board#*16 + channel), built once from the ShiftMap and
+	the ChannelMap. Each entry holds everything the per-hit path needs to know about a channel: the timestamp
+	shift applied at decode, and the detector type and attribute used by SlowSort to pick the destination
+	vector of the hit. Lookups are a bounds checked array index, so no hashing is done per hit. Channels
+	outside the table are treated as unshifted and unmapped.
+*/
+#ifndef CHANNELTABLE_H
+#define CHANNELTABLE_H
+
+#include "ChannelMap.h"
+#include "ShiftMap.h"
+
+namespace EventBuilder {
+
+	struct ChannelRoute
+	{
+		uint64_t shift = 0; //ps
+		bool mapped = false; //listed in the ChannelMap
+		DetType type = DetType::NoneType;
+		DetAttribute attribute = DetAttribute::NoneAttr; //also the index of the destination vector in SlowSort
+	};
+
+	class ChannelTable
+	{
+	public:
+		ChannelTable();
+		~ChannelTable();
+		void SetShifts(ShiftMap& smap);
+		void SetChannels(ChannelMap& cmap);
+
+		inline const ChannelRoute& GetRoute(int gchan) const { return gchan >= 0 && gchan < int(m_routes.size()) ? m_routes[gchan] : m_unrouted; }
+		inline uint64_t GetShift(int gchan) const { return GetRoute(gchan).shift; }
+
+	private:
+		ChannelRoute& Route(int gchan);
+
+		std::vector<ChannelRoute> m_routes; //indexed by global channel
+		ChannelRoute m_unrouted;
+	};
+
+}
+
+#endif
@@ -3,32 +3,141 @@
 	Wrapper class around a shared pointer to an ifstream. Here the shared pointer is used
 	to overcome limitations of the ifstream class, namely that it is written such that ifstream
 	cannot be modified by move semantics. Contains all information needed to parse a single binary
-	CompassFile. Currently has a class wide defined buffer size; may want to make this user input
-	in the future.
+	CompassFile. The buffer size defaults to 5M hits and can be set per file (see CompassRun buffer budget).
+
+	Files can alternatively be opened in MemoryMapped mode, where the whole binary is mapped into
+	memory and hits are parsed directly from the mapping (no staging buffer, no copy). InMemory files
+	work the same way on a block of data handed over by the caller (i.e. an archive member).
+	In Prefetch mode the file is buffered as usual, but the next buffer is read on a background thread
+	while the current one is being parsed (double buffering), at the cost of a second buffer per file.
+
+	Hits are decoded in batches by a kernel specialized on the CoMPASS header layout, selected once when
+	the header is read, so the per-hit path has no header tests; shifts come from the ChannelTable by index.
+	The batch is a structure-of-arrays HitBatch, which the HitMerger copies from in runs of hits.
+	An optional reorder stage (SetReorderDepth) repairs small local time disorder in the file as it is decoded.
+
+	Buffers are allocated on the first read and never exceed the file itself, so the buffer size can be
+	adjusted (SetBufferSize) any time between opening the file and pulling the first hit.
+
+	With a reorder depth set, each decoded batch goes through a bounded insertion sort which puts back hits
+	that are out of time order by up to that many places; the last depth hits are held back until the next
+	batch, so they can still be overtaken. Hits out of order by more than that are dropped. Both are counted.
 
 	Written by G.W. McCann Oct. 2020
 */
 #include "EventBuilder.h"
 #include "CompassFile.h"
+#include <cstring>
+#include <algorithm>
+#include <array>
+#include <utility>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
 
 namespace EventBuilder {
 
+	namespace {
+
+		template<typename T>
+		inline T ReadField(const char* data)
+		{
+			T value;
+			std::memcpy(&value, data, sizeof(T)); //records are packed, so fields are unaligned
+			return value;
+		}
+
+		/*
+			Decode kernel for one CoMPASS header layout. The field offsets and record size are compile time
+			constants, so for fixed size records the loop is a straight run of loads and stores. Waveform
+			records carry their own sample count, and are stepped one at a time (samples are skipped).
+			Hits are written into the columns of the batch from index first up to (not including) maxHits; the
+			calibrated energy and the waveform fields aren't used by the builder and are not kept.
+		*/
+		template<bool Energy, bool EnergyCalibrated, bool EnergyShort, bool Waves>
+		std::size_t DecodeHits(const char*& iter, const char* end, HitBatch& hits, std::size_t first, std::size_t maxHits)
+		{
+			constexpr std::size_t energyOffset = 12;
+			constexpr std::size_t calibratedOffset = energyOffset + (Energy ? 2 : 0);
+			constexpr std::size_t shortOffset = calibratedOffset + (EnergyCalibrated ? 8 : 0);
+			constexpr std::size_t flagsOffset = shortOffset + (EnergyShort ? 2 : 0);
+			constexpr std::size_t waveOffset = flagsOffset + 4;
+			constexpr std::size_t recordSize = waveOffset + (Waves ? 5 : 0);
+
+			std::size_t nhits = first;
+			const char* record = iter;
+			while(nhits < maxHits && (std::size_t)(end - record) >= recordSize)
+			{
+				hits.board[nhits] = ReadField<uint16_t>(record);
+				hits.channel[nhits] = ReadField<uint16_t>(record + 2);
+				hits.timestamp[nhits] = ReadField<uint64_t>(record + 4);
+				hits.energy[nhits] = Energy ? ReadField<uint16_t>(record + energyOffset) : 0;
+				hits.energyShort[nhits] = EnergyShort ? ReadField<uint16_t>(record + shortOffset) : 0;
+				hits.flags[nhits] = ReadField<uint32_t>(record + flagsOffset);
+				if constexpr(Waves)
+				{
+					uint32_t nsamples = ReadField<uint32_t>(record + waveOffset + 1);
+					if((std::size_t)(end - record) - recordSize < 2*(std::size_t)nsamples) //truncated waveform
+					{
+						record = end;
+						break;
+					}
+					record += recordSize + 2*nsamples; //Skip wavedata for SPS_CEBRA_EventBuilder
+				}
+				else
+					record += recordSize;
+				nhits++;
+			}
+			iter = record;
+			return nhits - first;
+		}
+
+		/*Kernels indexed by the layout bits of the CoMPASS header (Energy | EnergyCalibrated | EnergyShort | Waves)*/
+		template<std::size_t Layout>
+		constexpr auto GetDecoder() { return &DecodeHits<(Layout & 1) != 0, (Layout & 2) != 0, (Layout & 4) != 0, (Layout & 8) != 0>; }
+
+		template<std::size_t... Layouts>
+		constexpr auto MakeDecoderTable(std::index_sequence<Layouts...>) { return std::array<decltype(&DecodeHits<false, false, false, false>), sizeof...(Layouts)>{ GetDecoder<Layouts>()... }; }
+
+		constexpr auto s_decoderTable = MakeDecoderTable(std::make_index_sequence<16>{});
+	}
+
 	CompassFile::CompassFile() :
-		m_filename(""), m_bufferIter(nullptr), m_bufferEnd(nullptr), m_smap(nullptr), m_hitUsedFlag(true), m_hitsize(0), m_buffersize(0),
-		m_file(std::make_shared<std::ifstream>()), m_eofFlag(false)
+		m_filename(""), m_bufferIter(nullptr), m_bufferEnd(nullptr), m_channels(nullptr), m_hitUsedFlag(true), m_hitsize(0), m_buffersize(0),
+		m_batchPos(0), m_batchSize(0), m_heldHits(0), m_reorderDepth(0), m_releasedTime(0), m_reorderedHits(0), m_droppedHits(0), m_decoder(nullptr),
+		m_file(std::make_shared<std::ifstream>()), m_readMode(ReadMode::Buffered), m_eofFlag(false), m_readPos(0), m_readEnd(0), m_nHits(0)
 	{
 	}
 	
 	CompassFile::CompassFile(const std::string& filename) :
-		m_filename(""), m_bufferIter(nullptr), m_bufferEnd(nullptr), m_smap(nullptr), m_hitUsedFlag(true), m_hitsize(0), m_buffersize(0),
-		m_file(std::make_shared<std::ifstream>()), m_eofFlag(false)
+		m_filename(""), m_bufferIter(nullptr), m_bufferEnd(nullptr), m_channels(nullptr), m_hitUsedFlag(true), m_hitsize(0), m_buffersize(0),
+		m_batchPos(0), m_batchSize(0), m_heldHits(0), m_reorderDepth(0), m_releasedTime(0), m_reorderedHits(0), m_droppedHits(0), m_decoder(nullptr),
+		m_file(std::make_shared<std::ifstream>()), m_readMode(ReadMode::Buffered), m_eofFlag(false), m_readPos(0), m_readEnd(0), m_nHits(0)
 	{
 		Open(filename);
 	}
 	
 	CompassFile::CompassFile(const std::string& filename, int bsize) :
-		m_filename(""), m_bufferIter(nullptr), m_bufferEnd(nullptr), m_smap(nullptr), m_hitUsedFlag(true), m_bufsize(bsize), m_hitsize(0),
-		m_buffersize(0), m_file(std::make_shared<std::ifstream>()), m_eofFlag(false)
+		m_filename(""), m_bufferIter(nullptr), m_bufferEnd(nullptr), m_channels(nullptr), m_hitUsedFlag(true), m_bufsize(bsize), m_hitsize(0),
+		m_buffersize(0), m_batchPos(0), m_batchSize(0), m_heldHits(0), m_reorderDepth(0), m_releasedTime(0), m_reorderedHits(0), m_droppedHits(0), m_decoder(nullptr),
+		m_file(std::make_shared<std::ifstream>()), m_readMode(ReadMode::Buffered), m_eofFlag(false), m_readPos(0), m_readEnd(0), m_nHits(0)
+	{
+		Open(filename);
+	}
+
+	CompassFile::CompassFile(const std::string& filename, ReadMode mode) :
+		m_filename(""), m_bufferIter(nullptr), m_bufferEnd(nullptr), m_channels(nullptr), m_hitUsedFlag(true), m_hitsize(0), m_buffersize(0),
+		m_batchPos(0), m_batchSize(0), m_heldHits(0), m_reorderDepth(0), m_releasedTime(0), m_reorderedHits(0), m_droppedHits(0), m_decoder(nullptr),
+		m_file(std::make_shared<std::ifstream>()), m_readMode(mode), m_eofFlag(false), m_readPos(0), m_readEnd(0), m_nHits(0)
+	{
+		Open(filename);
+	}
+
+	CompassFile::CompassFile(const std::string& filename, const std::shared_ptr<const char>& data, uint64_t size) :
+		m_filename(""), m_bufferIter(nullptr), m_bufferEnd(nullptr), m_channels(nullptr), m_hitUsedFlag(true), m_hitsize(0), m_buffersize(0),
+		m_batchPos(0), m_batchSize(0), m_heldHits(0), m_reorderDepth(0), m_releasedTime(0), m_reorderedHits(0), m_droppedHits(0), m_decoder(nullptr),
+		m_file(std::make_shared<std::ifstream>()), m_map(data), m_readMode(ReadMode::InMemory), m_eofFlag(false), m_size(size), m_readPos(0), m_readEnd(0), m_nHits(0)
 	{
 		Open(filename);
 	}
@@ -43,6 +152,31 @@ namespace EventBuilder {
 		m_eofFlag = false;
 		m_hitUsedFlag = true;
 		m_filename = filename;
+		m_bufferIter = nullptr;
+		m_bufferEnd = nullptr;
+		m_batchPos = 0;
+		m_batchSize = 0;
+		ResetReorder();
+
+		//In place modes; InMemory data was attached by the constructor
+		if(IsInPlace())
+		{
+			if(m_readMode == ReadMode::MemoryMapped)
+				MapFile();
+			if(!IsOpen())
+				return;
+			else if(m_size <= 2)
+				m_eofFlag = true;
+			else
+			{
+				ReadHeader();
+				m_nHits = m_size/m_hitsize;
+				m_readPos = 2;
+				m_readEnd = m_size;
+			}
+			return;
+		}
+
 		m_file->open(m_filename, std::ios::binary | std::ios::in);
 	
 		m_file->seekg(0, std::ios_base::end);
@@ -56,17 +190,157 @@ namespace EventBuilder {
 			m_file->seekg(0, std::ios_base::beg);
 			ReadHeader();
 			m_nHits = m_size/m_hitsize;
-			m_buffersize = m_hitsize*m_bufsize;
-			m_hitBuffer.resize(m_buffersize);
+			m_readPos = 2;
+			m_readEnd = m_size;
+			SetBufferSize(m_bufsize);
+			if(m_readMode == ReadMode::Prefetch)
+				m_readAhead = std::make_shared<ReadAhead>();
 		}
 	}
+
+	/*
+		Buffer sizes are always a whole number of hits (a partial hit at the end of a buffer is dropped by the decoder)
+		and are capped one hit past the file contents, so that a small file is pulled in a single read.
+	*/
+	void CompassFile::SetBufferSize(int bsize)
+	{
+		m_bufsize = bsize;
+		if(m_hitsize == 0)
+			return;
+		uint64_t nhits = std::min<uint64_t>(bsize, m_nHits + 1);
+		m_buffersize = m_hitsize*nhits;
+	}
+
+	/*
+		Restrict the file to the hits [first, last), by index. Can be called at any time; it drops whatever has
+		been read so far and starts over at the first hit of the range. Requires fixed size records, as m_nHits does.
+	*/
+	void CompassFile::SetHitRange(uint64_t first, uint64_t last)
+	{
+		if(m_hitsize == 0)
+			return;
+		if(m_readAhead && m_readAhead->pending.valid())
+		{
+			m_readAhead->pending.wait();
+			m_readAhead->pending = std::future<std::streamsize>(); //drop anything read ahead
+		}
+
+		uint64_t total = (m_size - 2)/m_hitsize;
+		last = std::min(last, total);
+		first = std::min(first, last);
+		m_readPos = 2 + first*m_hitsize;
+		m_readEnd = 2 + last*m_hitsize;
+		m_nHits = last - first;
+		SetBufferSize(m_bufsize);
+
+		m_eofFlag = false;
+		m_hitUsedFlag = true;
+		m_bufferIter = nullptr;
+		m_bufferEnd = nullptr;
+		m_batchPos = 0;
+		m_batchSize = 0;
+		ResetReorder();
+	}
+
+	/*
+		Depth of the reorder stage, in hits; 0 turns it off. Capped at half a batch, so that every batch still
+		hands out hits. Like the buffer size, set it before the first hit is read.
+	*/
+	void CompassFile::SetReorderDepth(std::size_t depth)
+	{
+		m_reorderDepth = std::min(depth, GetMaxReorderDepth());
+	}
+
+	void CompassFile::ResetReorder()
+	{
+		m_heldHits = 0;
+		m_releasedTime = 0;
+		m_reorderedHits = 0;
+		m_droppedHits = 0;
+	}
+
+	/*
+		Random access to the (shifted) timestamp of the hit at index, for searching a file in time. Buffered files
+		share the stream with the regular reads; those always seek to their own position, so the two can be mixed.
+	*/
+	uint64_t CompassFile::ReadTimestamp(uint64_t index)
+	{
+		char record[12]; //board, channel, timestamp
+		uint64_t pos = 2 + index*m_hitsize;
+		if(IsInPlace())
+			std::memcpy(record, m_map.get() + pos, 12);
+		else
+		{
+			if(m_readAhead && m_readAhead->pending.valid())
+				m_readAhead->pending.wait();
+			m_file->clear();
+			m_file->seekg(pos, std::ios_base::beg);
+			m_file->read(record, 12);
+		}
+
+		uint16_t board, channel;
+		uint64_t timestamp;
+		std::memcpy(&board, record, 2);
+		std::memcpy(&channel, record + 2, 2);
+		std::memcpy(&timestamp, record + 4, 8);
+		if(m_channels != nullptr)
+			timestamp += m_channels->GetShift(channel + board*16);
+		return timestamp;
+	}
+
+	void CompassFile::AllocateBuffers()
+	{
+		m_hitBuffer.resize(m_buffersize);
+		if(m_readAhead)
+			m_readAhead->buffer.resize(m_buffersize);
+	}
 	
 	void CompassFile::Close() 
 	{
-		if(IsOpen()) 
+		//Never close the stream out from under an outstanding read
+		if(m_readAhead && m_readAhead->pending.valid())
+			m_readAhead->pending.wait();
+		if(m_file->is_open()) 
 		{
 			m_file->close();
 		}
+		m_map.reset();
+	}
+
+	/*
+		MapFile() maps the entire binary read-only into memory. The kernel is told we will walk it
+		front to back, so it can read ahead aggressively and drop pages behind us. The mapping is
+		held by a shared pointer, so copies of the CompassFile share it and the last one out unmaps.
+	*/
+	void CompassFile::MapFile()
+	{
+		int fd = open(m_filename.c_str(), O_RDONLY);
+		if(fd == -1)
+		{
+			EVB_WARN("Unable to open file {0} for memory mapping.", m_filename);
+			return;
+		}
+
+		struct stat info;
+		if(fstat(fd, &info) == -1 || info.st_size < 2)
+		{
+			EVB_WARN("Unable to determine the size of file {0}, or the file has no header. File not mapped.", m_filename);
+			close(fd);
+			return;
+		}
+		m_size = info.st_size;
+
+		void* address = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		close(fd); //mapping stays valid after the descriptor is closed
+		if(address == MAP_FAILED)
+		{
+			EVB_WARN("Memory mapping of file {0} failed.", m_filename);
+			return;
+		}
+		madvise(address, m_size, MADV_SEQUENTIAL);
+
+		size_t length = m_size;
+		m_map = MapPointer((const char*) address, [length](const char* ptr) { munmap((void*) ptr, length); });
 	}
 	
 	void CompassFile::ReadHeader() 
@@ -77,9 +351,13 @@ namespace EventBuilder {
 			return;
 		}
 
-		char* header = new char[2];
-		m_file->read(header, 2);
-		m_header = *((uint16_t*)header);
+		//Mapped files are read in place; buffered files are read through the stream and rewound
+		const bool mapped = IsInPlace();
+		if(mapped)
+			std::memcpy(&m_header, m_map.get(), 2);
+		else
+			m_file->read((char*)&m_header, 2);
+
 		m_hitsize = 16; //default hitsize of 16 bytes
 		if(IsEnergy())
 			m_hitsize += 2;
@@ -91,22 +369,29 @@ namespace EventBuilder {
 		{
 			EVB_ERROR("Waveforms are not supported by the SPS_CEBRA_EventBuilder. The wave data will be skipped.");
 			m_hitsize += 5;
-			char* firstHit = new char[m_hitsize]; //A compass hit by default has 24 bytes (at least in our setup)
-			m_file->read(firstHit, m_hitsize);
-			firstHit += m_hitsize - 4;
-			uint32_t nsamples = *((uint32_t*) firstHit);
+			uint32_t nsamples = 0; //Number of samples is the last field of the first hit
+			if(mapped)
+			{
+				if(m_size >= 2 + (unsigned int)m_hitsize)
+					std::memcpy(&nsamples, m_map.get() + 2 + m_hitsize - 4, 4);
+			}
+			else
+			{
+				std::vector<char> firstHit(m_hitsize); //A compass hit by default has 24 bytes (at least in our setup)
+				m_file->read(firstHit.data(), m_hitsize);
+				std::memcpy(&nsamples, firstHit.data() + m_hitsize - 4, 4);
+				m_file->seekg(2, std::ios_base::beg);
+			}
 			m_hitsize += nsamples * 2; //Each sample is a 2 byte data value
-			m_file->seekg(0, std::ios_base::beg);
-			m_file->read(header, 2);
-			delete[] firstHit;
 		}
-		
-		delete[] header;
+
+		m_decoder = s_decoderTable[m_header & (CoMPASSHeaders::Energy | CoMPASSHeaders::EnergyCalibrated | CoMPASSHeaders::EnergyShort | CoMPASSHeaders::Waves)];
 	}
 	
 	/*
 		GetNextHit() is the function which... gets the next hit
-		Has to check if the buffer needs refilled/filled for the first time
+		Steps through the decoded batch, decoding a new batch (and refilling the buffer first, if
+		needed) once the current one is used up.
 		Upon pulling a hit, sets the UsedFlag to false, letting the next level know
 		that the hit should be free game.
 	
@@ -116,85 +401,213 @@ namespace EventBuilder {
 	{
 		if(!IsOpen()) return true;
 	
-		if((m_bufferIter == nullptr || m_bufferIter == m_bufferEnd) && !IsEOF()) 
+		if(m_batchPos + 1 < m_batchSize)
 		{
-			GetNextBuffer();
+			m_batchPos++;
+			m_hitUsedFlag = false;
+			return m_eofFlag;
 		}
-	
-		if(!IsEOF()) 
+
+		while(!IsEOF())
 		{
-			ParseNextHit();
-			m_hitUsedFlag = false;
+			if(m_bufferIter == nullptr || m_bufferIter == m_bufferEnd)
+				GetNextBuffer();
+
+			if(IsEOF() && m_heldHits > 0)
+			{ //the end of the data releases the hits held back by the reorder stage
+				m_hitBatch.moveToFront(m_batchSize, m_heldHits);
+				m_batchPos = 0;
+				m_batchSize = m_heldHits;
+				m_heldHits = 0;
+				m_eofFlag = false;
+				m_hitUsedFlag = false;
+				break;
+			}
+
+			if(!IsEOF())
+			{
+				DecodeNextBatch();
+				if(m_batchSize > 0)
+				{
+					m_hitUsedFlag = false;
+					break;
+				}
+			}
 		}
 	
 		return m_eofFlag;
 	}
+
+	/*
+		Step past the current hit and the nhits-1 that follow it in the batch, landing on the next hit as
+		GetNextHit() would. Lets the HitMerger take a run of hits from the batch with one call.
+	*/
+	bool CompassFile::SkipHits(std::size_t nhits)
+	{
+		if(nhits == 0)
+			return m_eofFlag;
+		m_batchPos += nhits - 1;
+		return GetNextHit();
+	}
+
+	/*
+		DecodeNextBatch() runs the layout kernel over the buffer, then applies the timestamp shift, looked up
+		by global channel in the dense ChannelTable.
+		Any trailing partial record is discarded, so an empty batch always means the buffer is used up.
+		The batch columns are sized on first use, so files that are never read (scalers) don't hold a batch.
+		Hits held back by the reorder stage sit just past the valid hits of the batch; they are moved to the
+		front and the new hits decoded after them. If the buffer is used up they stay held for the next buffer.
+	*/
+	void CompassFile::DecodeNextBatch()
+	{
+		if(m_hitBatch.size() != s_batchCapacity)
+			m_hitBatch.resize(s_batchCapacity);
+		std::size_t held = m_heldHits;
+		m_hitBatch.moveToFront(m_batchSize, held);
+		m_batchPos = 0;
+		m_batchSize = 0;
+		std::size_t ndecoded = m_decoder(m_bufferIter, m_bufferEnd, m_hitBatch, held, s_batchCapacity);
+		if(ndecoded == 0)
+		{
+			m_bufferIter = m_bufferEnd;
+			return;
+		}
+
+		if(m_channels != nullptr) 
+		{ //memory safety
+			for(std::size_t i=held; i<held+ndecoded; i++)
+				m_hitBatch.timestamp[i] += m_channels->GetShift(m_hitBatch.GetGlobalChannel(i));
+		}
+
+		m_batchSize = held + ndecoded;
+		if(m_reorderDepth == 0)
+			return;
+
+		ReorderBatch(held);
+		m_heldHits = std::min(m_reorderDepth, m_batchSize);
+		m_batchSize -= m_heldHits;
+		if(m_batchSize > 0)
+			m_releasedTime = m_hitBatch.timestamp[m_batchSize - 1];
+	}
+
+	/*
+		Bounded insertion sort of the hits of the batch from first on; the hits before first are already in order.
+		A hit earlier than the one before it is moved back, past at most m_reorderDepth hits and never ahead of a hit
+		already handed out (m_releasedTime). A hit which doesn't fit within that is dropped. Equal timestamps keep
+		their file order. In order data costs one comparison per hit.
+	*/
+	void CompassFile::ReorderBatch(std::size_t first)
+	{
+		const uint64_t* times = m_hitBatch.timestamp.data();
+		std::size_t nkept = first;
+		for(std::size_t i=first; i<m_batchSize; i++)
+		{
+			uint64_t time = times[i];
+			uint64_t previous = nkept == 0 ? m_releasedTime : times[nkept - 1];
+			if(time < previous)
+			{
+				std::size_t lowest = nkept > m_reorderDepth ? nkept - m_reorderDepth : 0;
+				std::size_t pos = std::upper_bound(times + lowest, times + nkept, time) - times;
+				uint64_t floor = lowest == 0 ? m_releasedTime : times[lowest - 1];
+				if(pos == lowest && time < floor)
+				{
+					m_droppedHits++;
+					continue;
+				}
+				m_hitBatch.moveBack(i, nkept);
+				m_hitBatch.moveBack(nkept, pos);
+				m_reorderedHits++;
+			}
+			else if(i != nkept)
+				m_hitBatch.moveBack(i, nkept); //close the gap left by a dropped hit
+			nkept++;
+		}
+		m_batchSize = nkept;
+	}
 	
 	/*
 		GetNextBuffer() ... self-explanatory name
 		Note tht this is where the EOF flag is set. The EOF is only singaled
-		after the LAST buffer is completely read (i.e literally no more data). ifstream sets its eof 
-		bit upon pulling the last buffer, but this class waits until that entire
-		last buffer is read to singal EOF (the true end of file). 
+		after the LAST buffer is completely read (i.e literally no more data). Reads are bounded by the
+		byte range [m_readPos, m_readEnd) of the file (the whole file unless a hit range was set), and
+		this class waits until the last buffer of the range is used up to signal EOF.
 	*/
 	void CompassFile::GetNextBuffer() 
 	{
+		//The mapping is one big buffer: hand it out once (skipping the header), then signal EOF
+		if(IsInPlace())
+		{
+			if(m_bufferIter != nullptr)
+			{
+				m_eofFlag = true;
+				return;
+			}
+			m_bufferIter = m_map.get() + m_readPos;
+			m_bufferEnd = m_map.get() + m_readEnd;
+			return;
+		}
 	
-		if(m_file->eof()) 
+		if(m_hitBuffer.size() != (std::size_t)m_buffersize)
+			AllocateBuffers();
+
+		if(m_readMode == ReadMode::Prefetch)
+		{
+			//Collect the read in flight, swap it in, and immediately start on the next one.
+			//The stream is only touched from the main thread once the pending read has completed.
+			if(!m_readAhead->pending.valid())
+			{
+				if(m_readPos >= m_readEnd)
+				{
+					m_eofFlag = true;
+					return;
+				}
+				StartReadAhead();
+			}
+			std::streamsize nread = m_readAhead->pending.get();
+			m_hitBuffer.swap(m_readAhead->buffer);
+			m_bufferIter = m_hitBuffer.data();
+			m_bufferEnd = m_bufferIter + nread;
+			if(m_readPos < m_readEnd)
+				StartReadAhead();
+			return;
+		}
+	
+		if(m_readPos >= m_readEnd) 
 		{
 			m_eofFlag = true;
 			return;
 		}
 	
-		m_file->read(m_hitBuffer.data(), m_hitBuffer.size());
+		std::streamsize nbytes = std::min<uint64_t>(m_hitBuffer.size(), m_readEnd - m_readPos);
+		m_file->clear();
+		m_file->seekg(m_readPos, std::ios_base::beg);
+		m_file->read(m_hitBuffer.data(), nbytes);
+		m_readPos += nbytes;
 	
 		m_bufferIter = m_hitBuffer.data();
 		m_bufferEnd = m_bufferIter + m_file->gcount(); //one past the last datum
 	
 	}
-	
-	void CompassFile::ParseNextHit() 
+
+	/*
+		StartReadAhead() fills the spare buffer on a background thread. The task captures the stream and
+		the read-ahead state by pointer/shared pointer only, so the CompassFile itself may be copied or moved
+		while the read is in flight.
+	*/
+	void CompassFile::StartReadAhead()
 	{
-	
-		m_currentHit.board = *((uint16_t*)m_bufferIter);
-		m_bufferIter += 2;
-		m_currentHit.channel = *((uint16_t*)m_bufferIter);
-		m_bufferIter += 2;
-		m_currentHit.timestamp = *((uint64_t*)m_bufferIter);
-		m_bufferIter += 8;
-		if(IsEnergy())
-		{
-			m_currentHit.energy = *((uint16_t*)m_bufferIter);
-			m_bufferIter += 2;
-		}
-		if(IsEnergyCalibrated())
-		{
-			m_currentHit.energyCalibrated = *((uint64_t*)m_bufferIter);
-			m_bufferIter += 8;
-		}
-		if(IsEnergyShort())
+		FilePointer file = m_file;
+		ReadAhead* ahead = m_readAhead.get();
+		uint64_t position = m_readPos;
+		std::streamsize nbytes = std::min<uint64_t>(ahead->buffer.size(), m_readEnd - m_readPos);
+		m_readPos += nbytes;
+		ahead->pending = std::async(std::launch::async, [file, ahead, position, nbytes]()
 		{
-			m_currentHit.energyShort = *((uint16_t*)m_bufferIter);
-			m_bufferIter += 2;
-		}
-		m_currentHit.flags = *((uint32_t*)m_bufferIter);
-		m_bufferIter += 4;
-		if(IsWaves())
-		{
-			m_currentHit.waveCode = *((uint8_t*)m_bufferIter);
-			m_bufferIter += 1;
-			m_currentHit.Ns = *((uint32_t*)m_bufferIter);
-			m_bufferIter += 4;
-			m_bufferIter += 2*m_currentHit.Ns;
-			//Skip wavedata for SPS_CEBRA_EventBuilder
-		}
-	
-		if(m_smap != nullptr) 
-		{ //memory safety
-			int gchan = m_currentHit.channel + m_currentHit.board*16;
-			m_currentHit.timestamp += m_smap->GetShift(gchan);
-		}
-	
+			file->clear();
+			file->seekg(position, std::ios_base::beg);
+			file->read(ahead->buffer.data(), nbytes);
+			return file->gcount();
+		});
 	}
 
 }
\ No newline at end of file
@@ -3,17 +3,31 @@
 	Wrapper class around a shared pointer to an ifstream. Here the shared pointer is used
 	to overcome limitations of the ifstream class, namely that it is written such that ifstream
 	cannot be modified by move semantics. Contains all information needed to parse a single binary
-	CompassFile. Currently has a class wide defined buffer size; may want to make this user input
-	in the future.
+	CompassFile. The buffer size defaults to 5M hits and can be set per file (see CompassRun buffer budget).
+
+	Files can alternatively be opened in MemoryMapped mode, where the whole binary is mapped into
+	memory and hits are parsed directly from the mapping (no staging buffer, no copy). InMemory files
+	work the same way on a block of data handed over by the caller (i.e. an archive member).
+	In Prefetch mode the file is buffered as usual, but the next buffer is read on a background thread
+	while the current one is being parsed (double buffering), at the cost of a second buffer per file.
+
+	Hits are decoded in batches by a kernel specialized on the CoMPASS header layout, selected once when
+	the header is read, so the per-hit path has no header tests; shifts come from the ChannelTable by index.
+	The batch is a structure-of-arrays HitBatch, which the HitMerger copies from in runs of hits.
+	An optional reorder stage (SetReorderDepth) repairs small local time disorder in the file as it is decoded.
+
+	Buffers are allocated on the first read and never exceed the file itself, so the buffer size can be
+	adjusted (SetBufferSize) any time between opening the file and pulling the first hit.
 
 	Written by G.W. McCann Oct. 2020
 */
 #ifndef COMPASSFILE_H
 #define COMPASSFILE_H
 
-#include "CompassHit.h"
-#include "ShiftMap.h"
+#include "HitBatch.h"
+#include "ChannelTable.h"
 #include <memory>
+#include <future>
 
 namespace EventBuilder {
 
@@ -21,30 +35,59 @@ namespace EventBuilder {
 	{
 		
 	public:
+		enum ReadMode
+		{
+			Buffered,
+			MemoryMapped,
+			InMemory,
+			Prefetch
+		};
+
 		CompassFile();
 		CompassFile(const std::string& filename);
 		CompassFile(const std::string& filename, int bsize);
+		CompassFile(const std::string& filename, ReadMode mode);
+		CompassFile(const std::string& filename, const std::shared_ptr<const char>& data, uint64_t size);
 		~CompassFile();
 		void Open(const std::string& filename);
 		void Close();
 		bool GetNextHit();
+		bool SkipHits(std::size_t nhits); //GetNextHit() nhits times; the hits skipped must all be in the current batch
 	
-		inline bool IsOpen() const { return m_file->is_open(); };
-		inline CompassHit GetCurrentHit() const { return m_currentHit; }
+		inline bool IsOpen() const { return m_file->is_open() || m_map != nullptr; };
+		inline uint64_t GetCurrentTimestamp() const { return m_hitBatch.timestamp[m_batchPos]; }
+		inline const HitBatch& GetHitBatch() const { return m_hitBatch; } //only the first GetBatchSize() hits are valid
+		inline std::size_t GetBatchSize() const { return m_batchSize; }
+		inline std::size_t GetHitIndex() const { return m_batchPos; } //index of the current hit in GetHitBatch()
 		inline std::string GetName() const { return  m_filename; }
 		inline bool CheckHitHasBeenUsed() const { return m_hitUsedFlag; } //query to find out if we've used the current hit
 		inline void SetHitHasBeenUsed() { m_hitUsedFlag = true; } //flip the flag to indicate the current hit has been used
 		inline bool IsEOF() const { return m_eofFlag; } //see if we've read all available data
 		inline bool* GetUsedFlagPtr() { return &m_hitUsedFlag; }
-		inline void AttachShiftMap(ShiftMap* map) { m_smap = map; }
-		inline unsigned int GetSize() const { return m_size; }
+		inline void AttachChannelTable(const ChannelTable* channels) { m_channels = channels; }
+		inline uint64_t GetSize() const { return m_size; }
 		inline unsigned int GetNumberOfHits() const { return m_nHits; }
+		inline ReadMode GetReadMode() const { return m_readMode; }
+		inline int GetHitSize() const { return m_hitsize; }
+		void SetBufferSize(int bsize); //in hits; only valid before the first hit is read
+		void SetHitRange(uint64_t first, uint64_t last); //read only hits [first, last); restarts the file
+		uint64_t ReadTimestamp(uint64_t index); //shifted timestamp of a hit, by index
+		void SetReorderDepth(std::size_t depth); //in hits; 0 (default) for no reordering
+		inline uint64_t GetReorderedHits() const { return m_reorderedHits; } //hits put back in time order
+		inline uint64_t GetDroppedHits() const { return m_droppedHits; } //hits too far out of order to be put back
+		static constexpr std::size_t GetMaxReorderDepth() { return s_batchCapacity/2; }
 	
 	
 	private:
 		void ReadHeader();
-		void ParseNextHit();
+		void DecodeNextBatch();
+		void ReorderBatch(std::size_t first);
+		void ResetReorder();
 		void GetNextBuffer();
+		void MapFile();
+		void StartReadAhead();
+		void AllocateBuffers();
+		inline bool IsInPlace() const { return m_readMode == ReadMode::MemoryMapped || m_readMode == ReadMode::InMemory; }
 
 		inline bool IsEnergy() { return (m_header & CoMPASSHeaders::Energy) != 0; }
 		inline bool IsEnergyCalibrated() { return (m_header & CoMPASSHeaders::EnergyCalibrated) != 0; }
@@ -54,12 +97,23 @@ namespace EventBuilder {
 		using Buffer = std::vector<char>;
 	
 		using FilePointer = std::shared_ptr<std::ifstream>; //to make this class copy/movable
+		using MapPointer = std::shared_ptr<const char>; //releases the mapping/data when the last copy goes away
+		//Second buffer for Prefetch mode, filled by the pending read. The future is declared last so that
+		//its destructor (which blocks on an outstanding read) runs before the buffer is released.
+		struct ReadAhead
+		{
+			Buffer buffer;
+			std::future<std::streamsize> pending;
+		};
+		using ReadAheadPointer = std::shared_ptr<ReadAhead>; //future is move-only; keep the class copyable
+		//Decodes hits from [iter, end) into the batch from index first on, advancing iter. Returns the number of hits decoded.
+		using DecodeFunction = std::size_t (*)(const char*& iter, const char* end, HitBatch& hits, std::size_t first, std::size_t maxHits);
 	
 		std::string m_filename;
 		Buffer m_hitBuffer;
-		char* m_bufferIter;
-		char* m_bufferEnd;
-		ShiftMap* m_smap; //NOT owned by CompassFile. DO NOT delete
+		const char* m_bufferIter;
+		const char* m_bufferEnd;
+		const ChannelTable* m_channels; //NOT owned by CompassFile. DO NOT delete
 	
 		bool m_hitUsedFlag;
 		int m_bufsize = 5000000; //size of the buffer in hits
@@ -67,11 +121,24 @@ namespace EventBuilder {
 		uint16_t m_header;
 		int m_buffersize;
 	
-		CompassHit m_currentHit;
+		HitBatch m_hitBatch; //decoded hits, sized to s_batchCapacity; the current hit is at m_batchPos
+		std::size_t m_batchPos;
+		std::size_t m_batchSize; //number of valid hits in the batch
+		std::size_t m_heldHits; //hits held back by the reorder stage, just past the valid hits
+		std::size_t m_reorderDepth;
+		uint64_t m_releasedTime; //timestamp of the last hit let out of the reorder stage
+		uint64_t m_reorderedHits, m_droppedHits;
+		static constexpr std::size_t s_batchCapacity = 4096;
+		DecodeFunction m_decoder;
+
 		FilePointer m_file;
+		MapPointer m_map;
+		ReadAheadPointer m_readAhead;
+		ReadMode m_readMode;
 		bool m_eofFlag;
-		unsigned int m_size; //size of the file in bytes
-		unsigned int m_nHits; //number of hits in the file (m_size/24)
+		uint64_t m_size; //size of the file in bytes
+		uint64_t m_readPos, m_readEnd; //byte range of the file still to be read
+		unsigned int m_nHits; //number of hits in the file, or in the hit range if one is set
 
 		enum CoMPASSHeaders
 		{
@@ -16,6 +16,9 @@ namespace EventBuilder {
 		uint32_t Ns = 0;
 	};
 
+	//A time in ps given as a double (i.e. a window from the input file) in the integer ps of the timestamps
+	inline uint64_t ToPicoseconds(double time) { return time > 0.0 ? uint64_t(time + 0.5) : 0; }
+
 }
 
 #endif
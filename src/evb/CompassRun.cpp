@@ -15,17 +15,26 @@
 #include "SlowSort.h"
 #include "FastSort.h"
 #include "SFPAnalyzer.h"
-#include "FlagHandler.h"
+#include "ExternalSorter.h"
+#include "TimeSlicer.h"
+#include <TFileMerger.h>
+#include <TSystem.h>
+#include <atomic>
+#include <future>
+#include <memory>
+#include <thread>
 
 namespace EventBuilder {
 	
 	CompassRun::CompassRun() :
-		m_directory(""), m_scalerinput(""), m_runNum(0), m_scaler_flag(false), m_progressFraction(0.1)
+		m_directory(""), m_scalerinput(""), m_archive(""), m_rawInput(""), m_readMode(CompassFile::ReadMode::Buffered), m_bufferBudget(0), m_reorderDepth(0), m_sortMemory(0), m_trigger(DetAttribute::NoneAttr), m_triggerLookback(0.0), m_nThreads(1), m_isSlice(false),
+		m_writeRunParameters(true), m_flagTotals(nullptr), m_pipelined(false), m_runNum(0), m_scaler_flag(false), m_progressFraction(0.1)
 	{
 	}
 	
 	CompassRun::CompassRun(const std::string& dir) :
-		m_directory(dir), m_scalerinput(""), m_runNum(0), m_scaler_flag(false), m_progressFraction(0.1)
+		m_directory(dir), m_scalerinput(""), m_archive(""), m_rawInput(""), m_readMode(CompassFile::ReadMode::Buffered), m_bufferBudget(0), m_reorderDepth(0), m_sortMemory(0), m_trigger(DetAttribute::NoneAttr), m_triggerLookback(0.0), m_nThreads(1), m_isSlice(false),
+		m_writeRunParameters(true), m_flagTotals(nullptr), m_pipelined(false), m_runNum(0), m_scaler_flag(false), m_progressFraction(0.1)
 	{
 	
 	}
@@ -55,61 +64,140 @@ namespace EventBuilder {
 		input.close();
 	}
 	
+	/*
+		Open every binary of the run. Binaries are either read from the run directory, or, when an archive
+		is set, decompressed in memory from the archive. Archive members are named as if they had been
+		extracted to the run directory, so scaler files are matched the same way in both cases. Slices are
+		handed the binaries of their parent run, and open only their own hit range of each.
+	*/
 	bool CompassRun::GetBinaryFiles() 
 	{
-		std::string prefix = "";
-		std::string suffix = ".BIN"; //binaries
-		RunCollector grabber(m_directory, prefix, suffix);
-		grabber.GrabAllFiles();
-	
-		m_datafiles.clear(); //so that the CompassRun can be reused
-		m_datafiles.reserve(grabber.GetFileList().size());
-		bool scalerd;
-		m_totalHits = 0; //reset total run size
-	
-		for(auto& entry : grabber.GetFileList()) 
+		if(!m_isSlice)
 		{
-			//Handle scaler files, if they exist
-			if(m_scaler_flag) 
+			std::vector<std::string> filelist;
+			std::vector<ArchiveMember> members;
+			if(m_archive != "")
+			{
+				ArchiveReader reader(m_archive);
+				if(!reader.ReadMembers(".BIN", members))
+					return false;
+				for(auto& member : members)
+					filelist.push_back(m_directory + member.name);
+			}
+			else
+			{
+				std::string prefix = "";
+				std::string suffix = ".BIN"; //binaries
+				RunCollector grabber(m_directory, prefix, suffix);
+				grabber.GrabAllFiles();
+				filelist = grabber.GetFileList();
+			}
+
+			m_sources.clear(); //so that the CompassRun can be reused
+			bool scalerd;
+			for(std::size_t i=0; i<filelist.size(); i++) 
 			{
-				scalerd = false;
-				for(auto& scaler_pair : m_scaler_map) 
+				const std::string& entry = filelist[i];
+				//Handle scaler files, if they exist
+				if(m_scaler_flag) 
 				{
-					if(entry == scaler_pair.first) 
+					scalerd = false;
+					for(auto& scaler_pair : m_scaler_map) 
 					{
-						ReadScalerData(entry);
-						scalerd = true;
-						break;
+						if(entry == scaler_pair.first) 
+						{
+							if(m_archive != "")
+							{
+								CompassFile file(entry, members[i].data, members[i].size);
+								ReadScalerData(file);
+							}
+							else
+							{
+								CompassFile file(entry, m_readMode);
+								ReadScalerData(file);
+							}
+							scalerd = true;
+							break;
+						}
 					}
+					if(scalerd) 
+						continue;
 				}
-				if(scalerd) 
-					continue;
+
+				if(m_archive != "")
+					m_sources.push_back({entry, members[i].data, members[i].size});
+				else
+					m_sources.push_back({entry, nullptr, 0});
 			}
+		}
+	
+		m_datafiles.clear();
+		m_datafiles.reserve(m_sources.size());
+		m_totalHits = 0; //reset total run size
 	
-			m_datafiles.emplace_back(entry);
-			m_datafiles[m_datafiles.size()-1].AttachShiftMap(&m_smap);
+		for(std::size_t i=0; i<m_sources.size(); i++) 
+		{
+			const ArchiveMember& source = m_sources[i];
+			if(source.data != nullptr)
+				m_datafiles.emplace_back(source.name, source.data, source.size);
+			else
+				m_datafiles.emplace_back(source.name, m_readMode);
+			CompassFile& file = m_datafiles.back();
+			file.AttachChannelTable(&m_channels);
+			file.SetReorderDepth(m_reorderDepth);
 			//Any time we have a file that fails to be found, we terminate the whole process
-			if(!m_datafiles[m_datafiles.size() - 1].IsOpen()) 
+			if(!file.IsOpen()) 
 				return false;
+			if(m_isSlice)
+				file.SetHitRange(m_sliceFirst[i], m_sliceLast[i]);
 	
-			m_totalHits += m_datafiles[m_datafiles.size()-1].GetNumberOfHits();
+			m_totalHits += file.GetNumberOfHits();
 		}
+
+		DistributeBufferBudget();
 	
 		return true;
 	}
+
+	/*
+		Split the buffer budget over the data files in proportion to their size, i.e. their share of the hits
+		in the run. High rate channels get big buffers and few refills, while a quiet channel costs next to
+		nothing. Prefetch keeps two buffers per file, so each gets half a share. In place modes have no buffers.
+	*/
+	void CompassRun::DistributeBufferBudget()
+	{
+		if(m_bufferBudget == 0 || m_archive != "" || m_readMode == CompassFile::ReadMode::MemoryMapped)
+			return;
+
+		uint64_t totalSize = 0;
+		for(auto& file : m_datafiles)
+			totalSize += file.GetSize();
+		if(totalSize == 0)
+			return;
+
+		double budget = m_readMode == CompassFile::ReadMode::Prefetch ? m_bufferBudget*0.5 : m_bufferBudget;
+		for(auto& file : m_datafiles)
+		{
+			if(file.GetHitSize() == 0)
+				continue;
+			double share = budget * file.GetSize() / totalSize;
+			double maxHits = std::numeric_limits<int>::max() / file.GetHitSize(); //buffer size in bytes is an int
+			double nhits = std::min(std::max(share / file.GetHitSize(), double(s_minBufferHits)), maxHits);
+			file.SetBufferSize(int(nhits));
+		}
+	}
 	
 	/*
 		Pure counting of scalers. Potential upgrade path to something like
 		average count rate etc. 
 	*/
-	void CompassRun::ReadScalerData(const std::string& filename) 
+	void CompassRun::ReadScalerData(CompassFile& file) 
 	{
 		if(!m_scaler_flag) 
 			return;
 	
 		Long64_t count;
 		count = 0;
-		CompassFile file(filename);
 		auto& this_param = m_scaler_map[file.GetName()];
 		while(true) 
 		{
@@ -122,422 +210,710 @@ namespace EventBuilder {
 	}
 	
 	/*
-		GetHitsFromFiles() is the function which actually retrieves and sorts the data from the individual
-		files. There are several tricks which allow this to happen. First is that, after sorting, it is impossible
-		to determine which file the data originally came from (short of parsing the name of the file against board/channel).
-		However, we need to let the file know that we want it to pull the next hit. To do this, a pointer to the UsedFlag of the file
-		is retrieved along with the data. This flag is flipped so that on the next hit cycle a new hit is pulled. Second is the use
-		of a rolling start index. Once a file has gone EOF, we no longer need it. If this is the first file in the list, we can just skip
-		that index all together. In this way, the loop can go from N times to N-1 times.
+		Open the raw_root input in place of the binaries. Its scaler counts are taken over from the file, and
+		the binaries of any previous run are let go.
 	*/
-	bool CompassRun::GetHitsFromFiles() 
+	bool CompassRun::OpenRawInput()
 	{
-	
-		std::pair<CompassHit, bool*> earliestHit = std::make_pair(CompassHit(), nullptr);
-		for(unsigned int i=startIndex; i<m_datafiles.size(); i++) 
-		{
-			if(m_datafiles[i].CheckHitHasBeenUsed()) 
-				m_datafiles[i].GetNextHit();
-	
-			if(m_datafiles[i].IsEOF()) 
-			{
-				if(i == startIndex)
-					startIndex++;
-				continue;
-			} 
-			else if(i == startIndex) 
-			{
-				earliestHit = std::make_pair(m_datafiles[i].GetCurrentHit(), m_datafiles[i].GetUsedFlagPtr());
-			} 
-			else if(m_datafiles[i].GetCurrentHit().timestamp < earliestHit.first.timestamp) 
-			{
-				earliestHit = std::make_pair(m_datafiles[i].GetCurrentHit(), m_datafiles[i].GetUsedFlagPtr());
-			}
-		}
-	
-		if(earliestHit.second == nullptr) 
-			return false; //Make sure that there actually was a hit
-		hit = earliestHit.first;
-		*earliestHit.second = true;
+		m_datafiles.clear();
+		if(!m_rawReader.Open(m_rawInput))
+			return false;
+		m_totalHits = m_rawReader.GetNumberOfHits();
+		m_scaler_map.clear();
+		m_rawReader.ReadScalers(m_scaler_map);
 		return true;
 	}
-	
-	void CompassRun::Convert2RawRoot(const std::string& name) {
-		TFile* output = TFile::Open(name.c_str(), "RECREATE");
-		TTree* outtree = new TTree("Data", "Data");
-	
-		outtree->Branch("Board", &hit.board);
-		outtree->Branch("Channel", &hit.channel);
-		outtree->Branch("Energy", &hit.energy);
-		outtree->Branch("EnergyShort", &hit.energyShort);
-		outtree->Branch("Timestamp", &hit.timestamp);
-		outtree->Branch("Flags", &hit.flags);
-	
-		if(!m_smap.IsValid()) 
+
+	/*Next hits of the run, in time order: from the raw_root input if there is one, merged from the binaries otherwise*/
+	std::size_t CompassRun::GetNextHits(HitBatch& hits, std::size_t maxHits)
+	{
+		if(m_rawReader.IsOpen())
+			return m_rawReader.GetNextHits(hits, maxHits);
+		return m_merger.GetNextHits(hits, maxHits);
+	}
+
+	/*
+		Convert the run as a set of time slices, m_nThreads at a time. Each slice runs the regular conversion (convert)
+		in its own CompassRun, writing to its own temporary files, and the slice files of each output are then
+		concatenated in time order by the TFileMerger; histograms are summed. Run level objects (scalers, kinematic
+		parameters) are written by the first slice only, and progress is reported from this (the calling) thread.
+	*/
+	void CompassRun::ConvertSliced(const RunOutputs& outputs, double window, const SliceConversion& convert)
+	{
+		if(!m_smap.IsValid())
 		{
-			EVB_WARN("Bad shift map ({0}) at CompassRun::Convert(), shifts all set to 0.", m_smap.GetFilename());
+			EVB_WARN("Bad shift map ({0}) at CompassRun::ConvertSliced(), shifts all set to 0.", m_smap.GetFilename());
 		}
-	
+
 		SetScalers();
-	
-		if(!GetBinaryFiles()) 
+
+		if(!GetBinaryFiles())
 		{
-			EVB_ERROR("Unable to find binary files at CompassRun::Convert(), exiting!");
+			EVB_ERROR("Unable to find binary files at CompassRun::ConvertSliced(), exiting!");
 			return;
 		}
-	
-		unsigned int count = 0, flush = m_totalHits*m_progressFraction, flush_count = 0;
-	
-		startIndex = 0; //Reset the startIndex
-		if(flush == 0) 
-			flush = 1;
-		while(true) 
+
+		TimeSlicer slicer(window);
+		std::vector<std::vector<uint64_t>> bounds = slicer.FindSlices(m_datafiles, m_nThreads*s_slicesPerThread);
+		m_datafiles.clear();
+		std::size_t nslices = bounds.size() - 1;
+		EVB_INFO("Converting run in {0} time slices on {1} threads.", nslices, m_nThreads);
+
+		auto sliceName = [](const std::string& name, std::size_t index) { return name.empty() ? name : name + ".slice" + std::to_string(index); };
+		std::vector<RunOutputs> sliceOutputs;
+		for(std::size_t i=0; i<nslices; i++)
 		{
-			count++;
-			if(count == flush) 
-			{ //Progress Log
-				count = 0;
-				flush_count++;
-				m_progressCallback(flush_count*flush, m_totalHits);
+			RunOutputs slice = outputs;
+			slice.raw = sliceName(outputs.raw, i);
+			slice.sorted = sliceName(outputs.sorted, i);
+			slice.fast = sliceName(outputs.fast, i);
+			slice.analyzed = sliceName(outputs.analyzed, i);
+			sliceOutputs.push_back(slice);
+		}
+
+		ROOT::EnableThreadSafety();
+		std::atomic<std::size_t> nextSlice(0);
+		std::atomic<long> progress(0);
+		auto worker = [&]()
+		{
+			std::size_t index;
+			while((index = nextSlice++) < nslices)
+			{
+				CompassRun slice(m_directory);
+				slice.m_channels = m_channels;
+				slice.m_readMode = m_readMode;
+				slice.m_merger.SetMode(m_merger.GetMode());
+				slice.m_trigger = m_trigger;
+				slice.m_triggerLookback = m_triggerLookback;
+				slice.m_bufferBudget = m_bufferBudget/m_nThreads;
+				slice.m_isSlice = true;
+				slice.m_writeRunParameters = index == 0;
+				slice.m_sources = m_sources;
+				slice.m_sliceFirst = bounds[index];
+				slice.m_sliceLast = bounds[index + 1];
+				slice.m_flagTotals = m_flagTotals;
+				if(index == 0)
+					slice.m_scaler_map = m_scaler_map;
+
+				long reported = 0;
+				slice.m_progressFraction = m_progressFraction;
+				slice.m_progressCallback = [&progress, &reported](long curVal, long totalVal) { progress += curVal - reported; reported = curVal; };
+				convert(slice, sliceOutputs[index]);
+				progress += long(slice.m_totalHits) - reported;
+			}
+		};
+
+		std::vector<std::future<void>> workers;
+		for(int i=0; i<m_nThreads; i++)
+			workers.push_back(std::async(std::launch::async, worker));
+
+		long flush = std::max(long(m_totalHits*m_progressFraction), 1L), reported = 0;
+		for(auto& job : workers)
+		{
+			while(job.wait_for(std::chrono::milliseconds(200)) != std::future_status::ready)
+			{
+				long done = progress;
+				if(done - reported >= flush)
+				{
+					reported = done;
+					m_progressCallback(done, m_totalHits);
+				}
 			}
-	
-			if(!GetHitsFromFiles()) 
-				break;
-			outtree->Fill();
 		}
-	
-		output->cd();
-		outtree->Write(outtree->GetName(), TObject::kOverwrite);
-		for(auto& entry : m_scaler_map)
-			entry.second.Write();
-	
-		output->Close();
+
+		for(const std::string& name : { outputs.raw, outputs.sorted, outputs.fast, outputs.analyzed })
+		{
+			if(name.empty())
+				continue;
+
+			std::vector<std::string> slicenames;
+			for(std::size_t i=0; i<nslices; i++)
+				slicenames.push_back(sliceName(name, i));
+
+			TFileMerger merger(kFALSE, kFALSE);
+			merger.SetPrintLevel(0);
+			bool merged = merger.OutputFile(name.c_str(), "RECREATE");
+			for(auto& slicename : slicenames)
+				merged = merged && merger.AddFile(slicename.c_str(), kFALSE);
+			if(!merged || !merger.Merge())
+				EVB_ERROR("Unable to combine the time slices into {0} at CompassRun::ConvertSliced()!", name);
+
+			for(auto& slicename : slicenames)
+				std::remove(slicename.c_str());
+		}
 	}
-	
-	void CompassRun::Convert2SortedRoot(const std::string& name, const std::string& mapfile, double window) 
+
+	void CompassRun::Convert2RawRoot(const std::string& name)
 	{
-		TFile* output = TFile::Open(name.c_str(), "RECREATE");
-		TTree* outtree = new TTree("SortTree", "SortTree");
-	
-		outtree->Branch("event", &event);
-	
-		if(!m_smap.IsValid()) 
+		RunOutputs outputs;
+		outputs.raw = name;
+		Convert2MultiRoot(outputs, "", 0.0, 0.0, 0.0, 0, 0, 0, 0, 0, 0, 0.0, 0.0, 0.0);
+	}
+
+	void CompassRun::Convert2SortedRoot(const std::string& name, const std::string& mapfile, double window)
+	{
+		RunOutputs outputs;
+		outputs.sorted = name;
+		Convert2MultiRoot(outputs, mapfile, window, 0.0, 0.0, 0, 0, 0, 0, 0, 0, 0.0, 0.0, 0.0);
+	}
+
+	void CompassRun::Convert2FastSortedRoot(const std::string& name, const std::string& mapfile, double window, double fsi_window, double fic_window)
+	{
+		RunOutputs outputs;
+		outputs.fast = name;
+		Convert2MultiRoot(outputs, mapfile, window, fsi_window, fic_window, 0, 0, 0, 0, 0, 0, 0.0, 0.0, 0.0);
+	}
+
+	void CompassRun::Convert2SlowAnalyzedRoot(const std::string& name, const std::string& mapfile, double window,
+										  int zt, int at, int zp, int ap, int ze, int ae, double bke, double b, double theta)
+	{
+		RunOutputs outputs;
+		outputs.analyzed = name;
+		outputs.analyzeFast = false;
+		Convert2MultiRoot(outputs, mapfile, window, 0.0, 0.0, zt, at, zp, ap, ze, ae, bke, b, theta);
+	}
+
+	void CompassRun::Convert2FastAnalyzedRoot(const std::string& name, const std::string& mapfile, double window, double fsi_window, double fic_window,
+										  int zt, int at, int zp, int ap, int ze, int ae, double bke, double b, double theta)
+	{
+		RunOutputs outputs;
+		outputs.analyzed = name;
+		outputs.analyzeFast = true;
+		Convert2MultiRoot(outputs, mapfile, window, fsi_window, fic_window, zt, at, zp, ap, ze, ae, bke, b, theta);
+	}
+
+	/*
+		Write every requested output of the run in a single pass over the binaries. Only the stages the outputs need
+		are run: SlowSort for any event built output, FastSort for the fast output or a fast analysis, and SFPAnalyzer
+		for the analyzed output. Each output is its own file, holding the same objects as the single output conversion.
+	*/
+	void CompassRun::Convert2MultiRoot(const RunOutputs& outputs, const std::string& mapfile, double window, double fsi_window, double fic_window,
+									   int zt, int at, int zp, int ap, int ze, int ae, double bke, double b, double theta)
+	{
+		bool useSlow = !outputs.sorted.empty() || !outputs.fast.empty() || !outputs.analyzed.empty();
+		bool useFast = !outputs.fast.empty() || (!outputs.analyzed.empty() && outputs.analyzeFast);
+		bool useAnalyzer = !outputs.analyzed.empty();
+		if(!useSlow && outputs.raw.empty())
 		{
-			EVB_WARN("Bad shift map ({0}) at CompassRun::Convert2SortedRoot(), shifts all set to 0.", m_smap.GetFilename());
+			EVB_WARN("No outputs requested at CompassRun::Convert2MultiRoot(), nothing to do.");
+			return;
 		}
-	
-		SetScalers();
-	
-		if(!GetBinaryFiles()) 
+
+		if(!m_isSlice) //slices are handed the table of their parent
 		{
-			EVB_ERROR("Unable to find binary files at CompassRun::Convert2SortedRoot(), exiting!");
+			ChannelMap cmap(mapfile);
+			m_channels.SetShifts(m_smap);
+			m_channels.SetChannels(cmap);
+		}
+
+		if(!m_rawInput.empty() && outputs.raw == m_rawInput)
+		{
+			EVB_ERROR("The raw_root output {0} is also the input at CompassRun::Convert2MultiRoot(), exiting!", m_rawInput);
 			return;
 		}
-	
-		unsigned int count = 0, flush = m_totalHits*m_progressFraction, flush_count = 0;
-	
-		startIndex = 0;
-		SlowSort coincidizer(window, mapfile);
-		bool killFlag = false;
-		if(flush == 0) 
-			flush = 1;
-		while(true) 
+
+		if(m_nThreads > 1 && !m_isSlice && (m_sortMemory > 0 || !m_rawInput.empty() || m_reorderDepth > 0))
+			EVB_INFO("Runs built from a raw_root file, sorted out of core, or reordered can't be cut into time slices; building with a single thread.");
+		else if(m_nThreads > 1 && !m_isSlice)
 		{
-			count++;
-			if(count == flush) 
+			FlagHandler flagTotals(useFast ? GetEventLogName() : "");
+			m_flagTotals = &flagTotals;
+			//A slice must start clear of both the coincidence window and the trigger lookback of any event
+			double sliceWindow = m_trigger != DetAttribute::NoneAttr ? std::max(window, m_triggerLookback) : window;
+			ConvertSliced(outputs, useSlow ? sliceWindow : 0.0, [&](CompassRun& slice, const RunOutputs& sliceOutputs)
 			{
-				count = 0;
-				flush_count++;
-				m_progressCallback(flush_count*flush, m_totalHits);
+				slice.Convert2MultiRoot(sliceOutputs, mapfile, window, fsi_window, fic_window, zt, at, zp, ap, ze, ae, bke, b, theta);
+			});
+			m_flagTotals = nullptr;
+			return;
+		}
+
+		//Inputs first, so that a run which can't be read leaves no (truncated) outputs behind
+		if(!m_smap.IsValid() && !m_isSlice)
+		{
+			EVB_WARN("Bad shift map ({0}) at CompassRun::Convert2MultiRoot(), shifts all set to 0.", m_smap.GetFilename());
+		}
+
+		if(!m_rawInput.empty())
+		{
+			if(!OpenRawInput())
+			{
+				EVB_ERROR("Unable to read raw_root file {0} at CompassRun::Convert2MultiRoot(), exiting!", m_rawInput);
+				return;
 			}
-	
-			if(!GetHitsFromFiles()) 
+		}
+		else
+		{
+			SetScalers();
+
+			if(!GetBinaryFiles())
 			{
-				coincidizer.FlushHitsToEvent();
-				killFlag = true;
-			} 
-			else
-				coincidizer.AddHitToEvent(hit);
-	
-			if(coincidizer.IsEventReady()) 
+				EVB_ERROR("Unable to find binary files at CompassRun::Convert2MultiRoot(), exiting!");
+				return;
+			}
+		}
+
+		//Every output must be writable before any is recreated, so that a bad path doesn't truncate the others
+		for(auto name : { &outputs.raw, &outputs.sorted, &outputs.fast, &outputs.analyzed })
+		{
+			if(name->empty())
+				continue;
+			bool exists = !gSystem->AccessPathName(name->c_str());
+			std::string target = exists ? *name : std::string(gSystem->GetDirName(name->c_str()).Data());
+			if(gSystem->AccessPathName(target.c_str(), kWritePermission))
 			{
-				event = coincidizer.GetEvent();
-				outtree->Fill();
-				if(killFlag) break;
+				EVB_ERROR("Unable to write output file {0} at CompassRun::Convert2MultiRoot(), exiting!", *name);
+				m_rawReader.Close();
+				return;
 			}
 		}
-	
-		output->cd();
-		outtree->Write(outtree->GetName(), TObject::kOverwrite);
-		for(auto& entry : m_scaler_map)
-			entry.second.Write();
-	
-		coincidizer.GetEventStats()->Write();
-		output->Close();
+
+		//Each output is a tree in its own file; a new tree is created in the file opened last, so each file is checked before its tree
+		RunSinks sinks;
+		std::vector<std::pair<TFile*, TTree*>> files;
+		std::vector<std::string> filenames;
+		TFile* analyzedFile = nullptr;
+		auto openOutput = [&](const std::string& name, const char* treename)
+		{
+			TFile* output = TFile::Open(name.c_str(), "RECREATE");
+			if(output == nullptr || !output->IsOpen())
+			{
+				EVB_ERROR("Unable to open output file {0} at CompassRun::Convert2MultiRoot(), exiting!", name);
+				delete output;
+				for(std::size_t i=0; i<files.size(); i++) //the files this call recreated are empty; don't leave them behind
+				{
+					files[i].first->Close();
+					delete files[i].first;
+					std::remove(filenames[i].c_str());
+				}
+				files.clear();
+				m_rawReader.Close();
+				return (TTree*) nullptr;
+			}
+			files.emplace_back(output, new TTree(treename, treename));
+			filenames.push_back(name);
+			return files.back().second;
+		};
+		if(!outputs.raw.empty())
+		{
+			if((sinks.raw = openOutput(outputs.raw, "Data")) == nullptr)
+				return;
+			sinks.raw->Branch("Board", &hit.board);
+			sinks.raw->Branch("Channel", &hit.channel);
+			sinks.raw->Branch("Energy", &hit.energy);
+			sinks.raw->Branch("EnergyShort", &hit.energyShort);
+			sinks.raw->Branch("Timestamp", &hit.timestamp);
+			sinks.raw->Branch("Flags", &hit.flags);
+		}
+		if(!outputs.sorted.empty())
+		{
+			if((sinks.sorted = openOutput(outputs.sorted, "SortTree")) == nullptr)
+				return;
+			sinks.sorted->Branch("event", &event);
+		}
+		if(!outputs.fast.empty())
+		{
+			if((sinks.fast = openOutput(outputs.fast, "SortTree")) == nullptr)
+				return;
+			sinks.fast->Branch("event", &fastEvent);
+		}
+		if(!outputs.analyzed.empty())
+		{
+			if((sinks.analyzed = openOutput(outputs.analyzed, "SPSTree")) == nullptr)
+				return;
+			analyzedFile = files.back().first;
+			sinks.analyzed->Branch("event", &pevent);
+		}
+
+		std::unique_ptr<SlowSort> coincidizer;
+		std::unique_ptr<FastSort> speedyCoincidizer;
+		std::unique_ptr<SFPAnalyzer> analyzer;
+		std::unique_ptr<FlagHandler> flagger;
+		RunStages stages;
+		if(useSlow)
+		{
+			coincidizer = std::make_unique<SlowSort>(window, m_channels);
+			coincidizer->SetTrigger(m_trigger, m_triggerLookback);
+			stages.slow = coincidizer.get();
+		}
+		if(useFast)
+		{
+			speedyCoincidizer = std::make_unique<FastSort>(fsi_window, fic_window);
+			flagger = std::make_unique<FlagHandler>(m_isSlice ? "" : GetEventLogName()); //slices report to the parent's flag counts
+			stages.fast = speedyCoincidizer.get();
+			stages.flagger = flagger.get();
+		}
+		if(useAnalyzer)
+		{
+			analyzer = std::make_unique<SFPAnalyzer>(zt, at, zp, ap, ze, ae, bke, theta, b);
+			stages.analyzer = analyzer.get();
+			stages.analyzeFast = outputs.analyzeFast;
+		}
+
+		ProcessRun(stages, sinks);
+		ReportOrderRepairs(stages);
+		m_rawReader.Close();
+
+		for(auto& file : files)
+		{
+			TFile* output = file.first;
+			output->cd();
+			file.second->Write(file.second->GetName(), TObject::kOverwrite);
+			for(auto& entry : m_scaler_map)
+				entry.second.Write();
+
+			if(output == analyzedFile && m_writeRunParameters)
+			{
+				std::vector<TParameter<Double_t>> parvec;
+				parvec.reserve(9);
+				parvec.emplace_back("ZT", zt);
+				parvec.emplace_back("AT", at);
+				parvec.emplace_back("ZP", zp);
+				parvec.emplace_back("AP", ap);
+				parvec.emplace_back("ZE", ze);
+				parvec.emplace_back("AE", ae);
+				parvec.emplace_back("Bfield", b);
+				parvec.emplace_back("BeamKE", bke);
+				parvec.emplace_back("Theta", theta);
+				for(auto& entry : parvec)
+					entry.Write();
+			}
+
+			if(file.second != sinks.raw)
+				coincidizer->GetEventStats()->Write();
+			if(output == analyzedFile)
+			{
+				analyzer->GetHistograms().Write();
+			}
+			output->Close();
+			delete output;
+		}
+
+		if(m_flagTotals != nullptr && flagger)
+			m_flagTotals->Merge(*flagger);
 	}
-	
-	void CompassRun::Convert2FastSortedRoot(const std::string& name, const std::string& mapfile, double window, double fsi_window, double fic_window) 
+
+	/*
+		Log the hits which came out of a file out of time order: those put back in order by the reorder stage, and
+		those dropped, either by the reorder stage or, when they got past it, by SlowSort.
+	*/
+	void CompassRun::ReportOrderRepairs(const RunStages& stages)
 	{
-		TFile* output = TFile::Open(name.c_str(), "RECREATE");
-		TTree* outtree = new TTree("SortTree", "SortTree");
-	
-		outtree->Branch("event", &event);
-	
-		if(!m_smap.IsValid()) 
+		for(auto& file : m_datafiles)
 		{
-			EVB_WARN("Bad shift map ({0}) at CompassRun::Convert2FastSortedRoot(), shifts all set to 0.", m_smap.GetFilename());
+			if(file.GetDroppedHits() > 0)
+				EVB_WARN("{0} hits of file {1} were out of time order by more than the reorder depth ({2}), and were dropped.", file.GetDroppedHits(), file.GetName(), m_reorderDepth);
+			if(file.GetReorderedHits() > 0)
+				EVB_INFO("{0} out of order hits of file {1} were put back in time order.", file.GetReorderedHits(), file.GetName());
 		}
-	
-		SetScalers();
-	
-		if(!GetBinaryFiles()) 
+		if(stages.slow != nullptr && stages.slow->GetDroppedHits() > 0)
+			EVB_WARN("{0} out of order hits were dropped by SlowSort. Setting a ReorderDepth may recover them.", stages.slow->GetDroppedHits());
+	}
+
+	/*
+		ProcessRun() drives the conversion of the opened binaries: the time ordered hits go through the enabled
+		stages (SlowSort -> FastSort -> SFPAnalyzer, with the FlagHandler watching the hits going into SlowSort),
+		and every product with a sink is filled into it, through the branch variables hit, event, fastEvent and
+		pevent. The analyzer takes the fast events when analyzeFast is set, and the slow events otherwise.
+		Hits are merged and handed to the stages in batches of s_hitBatchSize. With an external sort the binaries are
+		first spilled to time ordered chunks on disk, which then stand in for the binaries.
+	*/
+	void CompassRun::ProcessRun(const RunStages& stages, const RunSinks& sinks)
+	{
+		ExternalSorter sorter(m_directory, m_sortMemory);
+		if(m_sortMemory > 0 && !m_rawReader.IsOpen())
 		{
-			EVB_ERROR("Unable to find binary files at CompassRun::Convert2FastSortedRoot(), exiting!");
+			if(!sorter.Spill(m_datafiles))
+			{
+				EVB_ERROR("Unable to sort the run out of core at CompassRun::ProcessRun(), exiting!");
+				return;
+			}
+			EVB_INFO("Sorted the run out of core in {0} chunks.", sorter.GetNumberOfChunks());
+			ReportOrderRepairs(RunStages());
+			m_datafiles = sorter.OpenChunks();
+		}
+
+		m_merger.Init(m_datafiles);
+		if(m_pipelined && !m_isSlice)
+		{
+			ProcessRunPipelined(stages, sinks);
 			return;
 		}
-	
-		unsigned int count = 0, flush = m_totalHits*m_progressFraction, flush_count = 0;
-	
-		startIndex = 0;
-		CoincEvent this_event;
-		std::vector<CoincEvent> fast_events;
-		SlowSort coincidizer(window, mapfile);
-		FastSort speedyCoincidizer(fsi_window, fic_window);
-	
-		FlagHandler flagger;
-	
-		bool killFlag = false;
-		if(flush == 0) 
-			flush = 1;
-		while(true) 
+
+		long flush = std::max(long(m_totalHits*m_progressFraction), 1L), merged = 0, reported = 0;
+		HitBatch hits;
+		hits.reserve(s_hitBatchSize);
+		while(GetNextHits(hits, s_hitBatchSize) > 0)
 		{
-			count++;
-			if(count == flush) 
-			{
-				count = 0;
-				flush_count++;
-				m_progressCallback(flush_count*flush, m_totalHits);
+			merged += hits.size();
+			if(merged - reported >= flush)
+			{ //Progress Log
+				reported = merged;
+				m_progressCallback(merged, m_totalHits);
 			}
-			
-			if(!GetHitsFromFiles()) 
-			{
-				coincidizer.FlushHitsToEvent();
-				killFlag = true;
-			} 
-			else 
+
+			if(sinks.raw != nullptr)
 			{
-				flagger.CheckFlag(hit.board, hit.channel, hit.flags);
-				coincidizer.AddHitToEvent(hit);
+				for(std::size_t i=0; i<hits.size(); i++)
+				{
+					hits.GetHit(i, hit);
+					sinks.raw->Fill();
+				}
 			}
-	
-			if(coincidizer.IsEventReady()) 
+
+			if(stages.slow != nullptr)
 			{
-				this_event = coincidizer.GetEvent();
-	
-				fast_events = speedyCoincidizer.GetFastEvents(this_event);
-				for(auto& entry : fast_events) 
+				if(stages.flagger != nullptr)
 				{
-					event = entry;
-					outtree->Fill();
+					for(std::size_t i=0; i<hits.size(); i++)
+						stages.flagger->CheckFlag(hits.board[i], hits.channel[i], hits.flags[i]);
+				}
+				std::size_t next = 0;
+				while(next < hits.size())
+				{
+					next = stages.slow->AddHitsToEvent(hits, next);
+					if(stages.slow->IsEventReady())
+						ProcessSlowEvent(stages, sinks);
 				}
-				if(killFlag) 
-					break;
 			}
+			hits.clear();
+		}
+
+		if(stages.slow != nullptr)
+		{
+			stages.slow->FlushHitsToEvent();
+			if(stages.slow->IsEventReady())
+				ProcessSlowEvent(stages, sinks);
 		}
-	
-		output->cd();
-		outtree->Write(outtree->GetName(), TObject::kOverwrite);
-		for(auto& entry : m_scaler_map)
-			entry.second.Write();
-		
-		coincidizer.GetEventStats()->Write();
-		output->Close();
 	}
-	
-	
-	void CompassRun::Convert2SlowAnalyzedRoot(const std::string& name, const std::string& mapfile, double window,
-										  int zt, int at, int zp, int ap, int ze, int ae, double bke, double b, double theta) 
+
+	/*Take the ready event from SlowSort and pass it down the remaining stages*/
+	void CompassRun::ProcessSlowEvent(const RunStages& stages, const RunSinks& sinks)
 	{
-	
-		TFile* output = TFile::Open(name.c_str(), "RECREATE");
-		TTree* outtree = new TTree("SPSTree", "SPSTree");
-	
-		outtree->Branch("event", &pevent);
-	
-		if(!m_smap.IsValid()) 
+		event = stages.slow->GetEvent();
+		if(sinks.sorted != nullptr)
+			sinks.sorted->Fill();
+
+		if(stages.fast != nullptr)
 		{
-			EVB_WARN("Bad shift map ({0}) at CompassRun::Convert2SlowAnalyzedRoot(), shifts all set to 0.", m_smap.GetFilename());
+			//fast events are built directly in the fast branch variable
+			stages.fast->GetFastEvents(event, fastEvent, [&](CoincEvent& entry)
+			{
+				if(sinks.fast != nullptr)
+					sinks.fast->Fill();
+				if(stages.analyzer != nullptr && stages.analyzeFast)
+				{
+					pevent = stages.analyzer->GetProcessedEvent(entry);
+					if(sinks.analyzed != nullptr)
+						sinks.analyzed->Fill();
+				}
+			});
 		}
-	
-		SetScalers();
-	
-		if(!GetBinaryFiles()) 
+
+		if(stages.analyzer != nullptr && !stages.analyzeFast)
 		{
-			EVB_ERROR("Unable to find binary files at CompassRun::Convert2SlowAnalyzedRoot(), exiting!");
-			return;
+			pevent = stages.analyzer->GetProcessedEvent(event);
+			if(sinks.analyzed != nullptr)
+				sinks.analyzed->Fill();
 		}
-	
-		unsigned int count = 0, flush = m_totalHits*m_progressFraction, flush_count = 0;
-	
-		startIndex = 0;
-		CoincEvent this_event;
-		SlowSort coincidizer(window, mapfile);
-		SFPAnalyzer analyzer(zt, at, zp, ap, ze, ae, bke, theta, b);
-	
-		std::vector<TParameter<Double_t>> parvec;
-		parvec.reserve(9);
-		parvec.emplace_back("ZT", zt);
-		parvec.emplace_back("AT", at);
-		parvec.emplace_back("ZP", zp);
-		parvec.emplace_back("AP", ap);
-		parvec.emplace_back("ZE", ze);
-		parvec.emplace_back("AE", ae);
-		parvec.emplace_back("Bfield", b);
-		parvec.emplace_back("BeamKE", bke);
-		parvec.emplace_back("Theta", theta);
-	
-		bool killFlag = false;
-		if(flush == 0) 
-			flush = 1;
-		while(true) 
+	}
+
+	/*
+		Pipelined version of ProcessRun(). Each stage runs on its own thread: decode & merge, SlowSort, FastSort
+		and SFPAnalyzer, connected by single producer/single consumer queues of batches. Every stage also sends
+		its product to the calling thread when it has a sink, and the calling thread does all of the TTree filling
+		(and so compression), as well as the progress reporting. Each product arrives in order, so every tree is
+		filled exactly as in the serial conversion.
+	*/
+	void CompassRun::ProcessRunPipelined(const RunStages& stages, const RunSinks& sinks)
+	{
+		ROOT::EnableThreadSafety();
+
+		SPSCQueue<HitBatch> hitsToSlow(s_queueDepth), hitsToFill(s_queueDepth);
+		SPSCQueue<EventBatch> slowToFast(s_queueDepth), slowToAnalyzer(s_queueDepth), slowToFill(s_queueDepth);
+		SPSCQueue<EventBatch> fastToAnalyzer(s_queueDepth), fastToFill(s_queueDepth);
+		SPSCQueue<ProcessedBatch> analyzerToFill(s_queueDepth);
+		QueueSignal fillSignal; //wakes the filling (this) thread when any of its queues moves
+		hitsToFill.SetSignal(&fillSignal);
+		slowToFill.SetSignal(&fillSignal);
+		fastToFill.SetSignal(&fillSignal);
+		analyzerToFill.SetSignal(&fillSignal);
+		std::atomic<long> hitsMerged(0);
+		std::vector<std::thread> threads;
+
+		//Decode & merge
+		threads.emplace_back([&]()
 		{
-			count++;
-			if(count == flush) 
-			{
-				count = 0;
-				flush_count++;
-				m_progressCallback(flush_count*flush, m_totalHits);
-			}
-	
-			if(!GetHitsFromFiles()) 
+			std::vector<SPSCQueue<HitBatch>*> outputs;
+			if(stages.slow != nullptr)
+				outputs.push_back(&hitsToSlow);
+			if(sinks.raw != nullptr)
+				outputs.push_back(&hitsToFill);
+			HitBatch batch;
+			batch.reserve(s_pipelineBatchSize);
+			while(GetNextHits(batch, s_pipelineBatchSize) > 0)
 			{
-				coincidizer.FlushHitsToEvent();
-				killFlag = true;
-			} 
-			else 
-			{
-				coincidizer.AddHitToEvent(hit);
+				hitsMerged += batch.size();
+				SendBatch(batch, outputs);
 			}
-	
-			if(coincidizer.IsEventReady()) 
+			for(auto queue : outputs)
+				queue->Close();
+		});
+
+		if(stages.slow != nullptr)
+		{
+			threads.emplace_back([&]()
 			{
-				this_event = coincidizer.GetEvent();
-				pevent = analyzer.GetProcessedEvent(this_event);
-				outtree->Fill();
-				if(killFlag) 
-					break;
-			}
+				std::vector<SPSCQueue<EventBatch>*> outputs;
+				if(stages.fast != nullptr)
+					outputs.push_back(&slowToFast);
+				if(stages.analyzer != nullptr && !stages.analyzeFast)
+					outputs.push_back(&slowToAnalyzer);
+				if(sinks.sorted != nullptr)
+					outputs.push_back(&slowToFill);
+				HitBatch hits;
+				EventBatch batch;
+				batch.reserve(s_pipelineBatchSize);
+				while(hitsToSlow.Pop(hits))
+				{
+					if(stages.flagger != nullptr)
+					{
+						for(std::size_t i=0; i<hits.size(); i++)
+							stages.flagger->CheckFlag(hits.board[i], hits.channel[i], hits.flags[i]);
+					}
+					std::size_t next = 0;
+					while(next < hits.size())
+					{
+						next = stages.slow->AddHitsToEvent(hits, next);
+						if(stages.slow->IsEventReady())
+							batch.push_back(stages.slow->GetEvent());
+					}
+					if(batch.size() >= s_pipelineBatchSize)
+						SendBatch(batch, outputs);
+				}
+				stages.slow->FlushHitsToEvent();
+				if(stages.slow->IsEventReady())
+					batch.push_back(stages.slow->GetEvent());
+				SendBatch(batch, outputs);
+				for(auto queue : outputs)
+					queue->Close();
+			});
 		}
-	
-		output->cd();
-		outtree->Write(outtree->GetName(), TObject::kOverwrite);
-		for(auto& entry : m_scaler_map)
-			entry.second.Write();
-	
-		for(auto& entry : parvec)
-			entry.Write();
-	
-		coincidizer.GetEventStats()->Write();
-		analyzer.GetHashTable()->Write();
-		analyzer.ClearHashTable();
-		output->Close();
-	}
-	
-	void CompassRun::Convert2FastAnalyzedRoot(const std::string& name, const std::string& mapfile, double window, double fsi_window, double fic_window,
-										  int zt, int at, int zp, int ap, int ze, int ae, double bke, double b, double theta) 
-	{
-	
-		TFile* output = TFile::Open(name.c_str(), "RECREATE");
-		TTree* outtree = new TTree("SPSTree", "SPSTree");
-	
-		outtree->Branch("event", &pevent);
-	
-		if(!m_smap.IsValid()) 
+
+		if(stages.fast != nullptr)
 		{
-			EVB_WARN("Bad shift map ({0}) at CompassRun::Convert2FastAnalyzedRoot(), shifts all set to 0.", m_smap.GetFilename());
+			threads.emplace_back([&]()
+			{
+				std::vector<SPSCQueue<EventBatch>*> outputs;
+				if(stages.analyzer != nullptr && stages.analyzeFast)
+					outputs.push_back(&fastToAnalyzer);
+				if(sinks.fast != nullptr)
+					outputs.push_back(&fastToFill);
+				EventBatch events;
+				EventBatch batch;
+				batch.reserve(s_pipelineBatchSize);
+				CoincEvent buffer;
+				while(slowToFast.Pop(events))
+				{
+					for(auto& entry : events)
+						stages.fast->GetFastEvents(entry, buffer, [&batch](CoincEvent& fast_event) { batch.push_back(fast_event); });
+					if(batch.size() >= s_pipelineBatchSize)
+						SendBatch(batch, outputs);
+				}
+				SendBatch(batch, outputs);
+				for(auto queue : outputs)
+					queue->Close();
+			});
 		}
-	
-		SetScalers();
-	
-		if(!GetBinaryFiles()) 
+
+		if(stages.analyzer != nullptr)
 		{
-			EVB_ERROR("Unable to find binary files at CompassRun::Convert2FastAnalyzedRoot(), exiting!");
-			return;
+			threads.emplace_back([&]()
+			{
+				SPSCQueue<EventBatch>& input = stages.analyzeFast ? fastToAnalyzer : slowToAnalyzer;
+				std::vector<SPSCQueue<ProcessedBatch>*> outputs;
+				if(sinks.analyzed != nullptr)
+					outputs.push_back(&analyzerToFill);
+				EventBatch events;
+				ProcessedBatch batch;
+				batch.reserve(s_pipelineBatchSize);
+				while(input.Pop(events))
+				{
+					for(auto& entry : events)
+						batch.push_back(stages.analyzer->GetProcessedEvent(entry));
+					if(batch.size() >= s_pipelineBatchSize)
+						SendBatch(batch, outputs);
+				}
+				SendBatch(batch, outputs);
+				for(auto queue : outputs)
+					queue->Close();
+			});
 		}
-	
-		unsigned int count = 0, flush = m_totalHits*m_progressFraction, flush_count = 0;
-	
-		startIndex = 0;
-		CoincEvent this_event;
-		std::vector<CoincEvent> fast_events;
-		SlowSort coincidizer(window, mapfile);
-		FastSort speedyCoincidizer(fsi_window, fic_window);
-		SFPAnalyzer analyzer(zt, at, zp, ap, ze, ae, bke, theta, b);
-	
-		std::vector<TParameter<Double_t>> parvec;
-		parvec.reserve(9);
-		parvec.emplace_back("ZT", zt);
-		parvec.emplace_back("AT", at);
-		parvec.emplace_back("ZP", zp);
-		parvec.emplace_back("AP", ap);
-		parvec.emplace_back("ZE", ze);
-		parvec.emplace_back("AE", ae);
-		parvec.emplace_back("Bfield", b);
-		parvec.emplace_back("BeamKE", bke);
-		parvec.emplace_back("Theta", theta);
-	
-		FlagHandler flagger;
-	
-		bool killFlag = false;
-		if(flush == 0) 
-			flush = 1;
-		while(true) 
+
+		//Fill stage, on this thread
+		long flush = std::max(long(m_totalHits*m_progressFraction), 1L), reported = 0;
+		HitBatch hits;
+		EventBatch events;
+		ProcessedBatch processed;
+		while(true)
 		{
-			count++;
-			if(count == flush) 
+			//Check for the end before draining, so that nothing sent before the close is missed
+			uint64_t signalled = fillSignal.GetCount();
+			bool done = (sinks.raw == nullptr || hitsToFill.IsFinished()) && (sinks.sorted == nullptr || slowToFill.IsFinished())
+						&& (sinks.fast == nullptr || fastToFill.IsFinished()) && (sinks.analyzed == nullptr || analyzerToFill.IsFinished());
+			bool idle = true;
+
+			while(sinks.raw != nullptr && hitsToFill.TryPop(hits))
 			{
-				count = 0;
-				flush_count++;
-				m_progressCallback(flush_count*flush, m_totalHits);
+				for(std::size_t i=0; i<hits.size(); i++)
+				{
+					hits.GetHit(i, hit);
+					sinks.raw->Fill();
+				}
+				idle = false;
 			}
-	
-			if(!GetHitsFromFiles()) 
+			while(sinks.sorted != nullptr && slowToFill.TryPop(events))
 			{
-				coincidizer.FlushHitsToEvent();
-				killFlag = true;
-			} 
-			else 
+				for(auto& entry : events)
+				{
+					event = entry;
+					sinks.sorted->Fill();
+				}
+				idle = false;
+			}
+			while(sinks.fast != nullptr && fastToFill.TryPop(events))
 			{
-				flagger.CheckFlag(hit.board, hit.channel, hit.flags);
-				coincidizer.AddHitToEvent(hit);
+				for(auto& entry : events)
+				{
+					fastEvent = entry;
+					sinks.fast->Fill();
+				}
+				idle = false;
 			}
-	
-			if(coincidizer.IsEventReady()) 
+			while(sinks.analyzed != nullptr && analyzerToFill.TryPop(processed))
 			{
-				this_event = coincidizer.GetEvent();
-	
-				fast_events = speedyCoincidizer.GetFastEvents(this_event);
-				for(auto& entry : fast_events) 
+				for(auto& entry : processed)
 				{
-					pevent = analyzer.GetProcessedEvent(entry);
-					outtree->Fill();
+					pevent = entry;
+					sinks.analyzed->Fill();
 				}
-				if(killFlag) 
-					break;
+				idle = false;
 			}
+
+			long merged = hitsMerged;
+			if(merged - reported >= flush)
+			{
+				reported = merged;
+				m_progressCallback(merged, m_totalHits);
+			}
+
+			if(done)
+				break;
+			else if(idle) //sleep until a queue moves; the timeout keeps the progress reports coming
+				fillSignal.Wait(signalled, std::chrono::milliseconds(200));
 		}
-	
-		output->cd();
-		outtree->Write(outtree->GetName(), TObject::kOverwrite);
-		for(auto& entry : m_scaler_map) 
-			entry.second.Write();
-	
-		for(auto& entry : parvec)
-			entry.Write();
-	
-		coincidizer.GetEventStats()->Write();
-		analyzer.GetHashTable()->Write();
-		analyzer.ClearHashTable();
-		output->Close();
+
+		for(auto& thread : threads)
+			thread.join();
 	}
-}
\ No newline at end of file
+}
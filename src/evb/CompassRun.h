@@ -5,19 +5,69 @@
 	CompassFiles from which to draw data. It then draws data from these files, organizes them in time,
 	and writes to a ROOT file for further processing.
 
+	With more than one thread, a run is cut into time slices (see TimeSlicer) which are converted in
+	parallel, each by its own CompassRun, and the slice outputs are concatenated in time order.
+	Events can also be built from a raw_root file (SetRawInput) instead of the binaries; the hits then come
+	straight out of its Data tree, in order, and the run isn't sliced.
+	With an external sort memory cap set, the hits are first sorted out of core (see ExternalSorter), for runs
+	whose binaries are not time ordered; such runs can't be sliced, so they are always built by one thread.
+	Likewise for runs read with a reorder depth (see CompassFile::SetReorderDepth), whose binaries aren't in order either.
+	With the pipeline enabled, the stages of a single conversion (decode & merge, SlowSort, FastSort,
+	SFPAnalyzer and the TTree filling) each run on their own thread instead. Slices are always converted
+	serially, as the slices already keep the threads busy.
+
 	Written by G.W. McCann Oct. 2020
 */
 #ifndef COMPASSRUN_H
 #define COMPASSRUN_H
 
 #include "CompassFile.h"
+#include "HitMerger.h"
+#include "ArchiveReader.h"
+#include "RawTreeReader.h"
+#include "FlagHandler.h"
 #include "DataStructs.h"
 #include "RunCollector.h"
 #include "ShiftMap.h"
+#include "ChannelTable.h"
 #include "ProgressCallback.h"
+#include "SPSCQueue.h"
 #include <TParameter.h>
 
 namespace EventBuilder {
+
+	class SlowSort;
+	class FastSort;
+	class SFPAnalyzer;
+
+	//Stages of a conversion; a null stage is skipped
+	struct RunStages
+	{
+		SlowSort* slow = nullptr;
+		FastSort* fast = nullptr;
+		SFPAnalyzer* analyzer = nullptr;
+		FlagHandler* flagger = nullptr;
+		bool analyzeFast = false; //the analyzer takes the fast events rather than the slow events
+	};
+
+	//Files written by a single pass over a run; an empty name isn't written
+	struct RunOutputs
+	{
+		std::string raw;
+		std::string sorted;
+		std::string fast;
+		std::string analyzed;
+		bool analyzeFast = false; //analyze the fast events rather than the slow events
+	};
+
+	//Trees the products of the stages are filled into; a null tree isn't filled
+	struct RunSinks
+	{
+		TTree* raw = nullptr; //hits
+		TTree* sorted = nullptr; //slow events
+		TTree* fast = nullptr; //fast events
+		TTree* analyzed = nullptr; //processed events
+	};
 	
 	class CompassRun 
 	{
@@ -30,6 +80,16 @@ namespace EventBuilder {
 		inline void SetScalerInput(const std::string& filename) { m_scalerinput = filename; }
 		inline void SetRunNumber(int n) { m_runNum = n; }
 		inline void SetShiftMap(const std::string& filename) { m_smap.SetFile(filename); }
+		inline void SetReadMode(CompassFile::ReadMode mode) { m_readMode = mode; }
+		inline void SetArchive(const std::string& filename) { m_archive = filename; } //empty to read binaries from the directory
+		inline void SetRawInput(const std::string& filename) { m_rawInput = filename; } //raw_root file to build from; empty to read the binaries
+		inline void SetBufferBudget(uint64_t bytes) { m_bufferBudget = bytes; } //total for all file buffers; 0 for no budget
+		inline void SetThreads(int n) { m_nThreads = n > 1 ? n : 1; }
+		inline void SetPipeline(bool pipelined) { m_pipelined = pipelined; }
+		inline void SetMergeMode(HitMerger::MergeMode mode) { m_merger.SetMode(mode); }
+		inline void SetReorderDepth(std::size_t depth) { m_reorderDepth = depth; } //see CompassFile::SetReorderDepth
+		inline void SetExternalSort(uint64_t bytes) { m_sortMemory = bytes; } //memory cap for sorting out of core; 0 to merge the binaries directly
+		inline void SetTrigger(DetAttribute trigger, double lookback) { m_trigger = trigger; m_triggerLookback = lookback; } //see SlowSort::SetTrigger
 		void Convert2RawRoot(const std::string& name);
 		void Convert2SortedRoot(const std::string& name, const std::string& mapfile, double window);
 		void Convert2FastSortedRoot(const std::string& name, const std::string& mapfile, double window, double fsi_window, double fic_window);
@@ -37,25 +97,79 @@ namespace EventBuilder {
 								  int zt, int at, int zp, int ap, int ze, int ae, double bke, double b, double theta);
 		void Convert2FastAnalyzedRoot(const std::string& name, const std::string& mapfile, double window, double fsi_window, double fic_window,
 								  int zt, int at, int zp, int ap, int ze, int ae, double bke, double b, double theta);
+		void Convert2MultiRoot(const RunOutputs& outputs, const std::string& mapfile, double window, double fsi_window, double fic_window,
+							   int zt, int at, int zp, int ap, int ze, int ae, double bke, double b, double theta);
 	
 		inline void SetProgressCallbackFunc(const ProgressCallbackFunc& function) { m_progressCallback = function; }
 		inline void SetProgressFraction(double frac) { m_progressFraction = frac; }
 	
 	private:
+		using SliceConversion = std::function<void(CompassRun& slice, const RunOutputs& sliceOutputs)>;
+		using EventBatch = std::vector<CoincEvent>;
+		using ProcessedBatch = std::vector<ProcessedEvent>;
+
+		void ConvertSliced(const RunOutputs& outputs, double window, const SliceConversion& convert);
 		bool GetBinaryFiles();
-		bool GetHitsFromFiles();
+		bool OpenRawInput();
+		std::size_t GetNextHits(HitBatch& hits, std::size_t maxHits);
 		void SetScalers();
-		void ReadScalerData(const std::string& filename);
+		void ReadScalerData(CompassFile& file);
+		void DistributeBufferBudget();
+		void ProcessRun(const RunStages& stages, const RunSinks& sinks);
+		void ProcessSlowEvent(const RunStages& stages, const RunSinks& sinks);
+		void ProcessRunPipelined(const RunStages& stages, const RunSinks& sinks);
+		void ReportOrderRepairs(const RunStages& stages);
+		inline std::string GetEventLogName() const { return "./event_log_run_" + std::to_string(m_runNum) + ".txt"; } //per run, so that concurrent jobs don't share a log
+
+		/*Send a batch to every queue in queues (copies for all but the last). The batch is left empty.*/
+		template<typename Batch>
+		static void SendBatch(Batch& batch, const std::vector<SPSCQueue<Batch>*>& queues)
+		{
+			if(!batch.empty() && !queues.empty())
+			{
+				for(std::size_t i=0; i<queues.size()-1; i++)
+					queues[i]->Push(Batch(batch));
+				queues.back()->Push(std::move(batch));
+			}
+			batch.clear();
+			batch.reserve(s_pipelineBatchSize);
+		}
 	
-		std::string m_directory, m_scalerinput;
+		std::string m_directory, m_scalerinput, m_archive, m_rawInput;
 		std::vector<CompassFile> m_datafiles;
-		unsigned int startIndex; //this is the file we start looking at; increases as we finish files.
+		std::vector<ArchiveMember> m_sources; //data binaries of the run; data is only set for binaries read from an archive
+		HitMerger m_merger; //time orders the hits across m_datafiles
+		RawTreeReader m_rawReader; //hit source in place of the merger when building from a raw_root file
+		static constexpr std::size_t s_hitBatchSize = 4096; //hits merged at a time
 		ShiftMap m_smap;
+		ChannelTable m_channels; //shifts and detector assignments by global channel, built from m_smap and the channel map
+		CompassFile::ReadMode m_readMode;
+		uint64_t m_bufferBudget; //bytes
+		static constexpr int s_minBufferHits = 1024; //floor so that low rate channels aren't refilled hit by hit
+		std::size_t m_reorderDepth; //hits; 0 for no reordering
+		uint64_t m_sortMemory; //bytes; 0 for no external sort
+		DetAttribute m_trigger; //attribute that opens slow events; NoneAttr for any hit
+		double m_triggerLookback; //ps
+
+		//Time slicing
+		int m_nThreads;
+		bool m_isSlice; //this run converts one slice of a parent run
+		bool m_writeRunParameters; //only the first slice writes the kinematic parameters
+		std::vector<uint64_t> m_sliceFirst, m_sliceLast; //hit range of each of m_sources
+		FlagHandler* m_flagTotals; //NOT owned; slices add their flag counts to the parent's
+		static constexpr int s_slicesPerThread = 4; //more slices than threads, to balance uneven rates
+
+		//Pipelining
+		bool m_pipelined;
+		static constexpr std::size_t s_pipelineBatchSize = 1024; //items per queue entry
+		static constexpr std::size_t s_queueDepth = 16; //batches in flight between two stages
+
 		std::unordered_map<std::string, TParameter<Long64_t>> m_scaler_map; //maps scaler files to the TParameter to be saved
 	
 		//Potential branch variables
 		CompassHit hit;
 		CoincEvent event;
+		CoincEvent fastEvent;
 		ProcessedEvent pevent;
 	
 		//what run is this
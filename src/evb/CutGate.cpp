@@ -0,0 +1,108 @@
+/*
+	CutGate.cpp
+	A boolean combination of the cuts of a cut list, i.e. protons&!deuterons or (ede|theta)&xavgRange, where each
+	name is the name of a cut in the list, Cut stands for every cut of the list at once, and ! binds tighter than &,
+	which binds tighter than |. A gate is compiled once against a CutHandler into a postfix program over the bits of
+	the mask from CutHandler::GetInsideMask, so every cut is tested once per event however many gates use it, and a
+	gate is then a few bit operations.
+*/
+#include "EventBuilder.h"
+#include "CutGate.h"
+
+namespace EventBuilder {
+
+	CutGate::CutGate() :
+		m_cuts(nullptr), m_maxDepth(0)
+	{
+	}
+
+	/*Returns false (leaving the gate unusable) for malformed text or names not in the cut list*/
+	bool CutGate::Compile(const std::string& text, const CutHandler& cuts)
+	{
+		m_text = text;
+		m_program.clear();
+		m_cuts = &cuts;
+		m_maxDepth = 0;
+		std::size_t pos = 0;
+		bool valid = ParseOr(pos, 0) && pos == m_text.size() && m_maxDepth <= s_maxDepth;
+		m_cuts = nullptr;
+		if(!valid)
+			m_program.clear();
+		return valid;
+	}
+
+	/*depth is the number of values on the stack before the parsed term*/
+	bool CutGate::ParseOr(std::size_t& pos, int depth)
+	{
+		if(!ParseAnd(pos, depth))
+			return false;
+		while(pos < m_text.size() && m_text[pos] == '|')
+		{
+			pos++;
+			if(!ParseAnd(pos, depth+1))
+				return false;
+			Emit(OpCode::Or, 0, depth+1);
+		}
+		return true;
+	}
+
+	bool CutGate::ParseAnd(std::size_t& pos, int depth)
+	{
+		if(!ParseUnary(pos, depth))
+			return false;
+		while(pos < m_text.size() && m_text[pos] == '&')
+		{
+			pos++;
+			if(!ParseUnary(pos, depth+1))
+				return false;
+			Emit(OpCode::And, 0, depth+1);
+		}
+		return true;
+	}
+
+	bool CutGate::ParseUnary(std::size_t& pos, int depth)
+	{
+		if(pos >= m_text.size())
+			return false;
+
+		if(m_text[pos] == '!')
+		{
+			pos++;
+			if(!ParseUnary(pos, depth))
+				return false;
+			Emit(OpCode::Not, 0, depth+1);
+			return true;
+		}
+		else if(m_text[pos] == '(')
+		{
+			pos++;
+			if(!ParseOr(pos, depth) || pos >= m_text.size() || m_text[pos] != ')')
+				return false;
+			pos++;
+			return true;
+		}
+
+		std::size_t end = m_text.find_first_of("!&|()", pos);
+		if(end == std::string::npos)
+			end = m_text.size();
+		std::string name = m_text.substr(pos, end - pos);
+		uint64_t bits;
+		if(name == "Cut")
+			bits = m_cuts->GetAllCutBits();
+		else if(!m_cuts->GetCutBit(name, bits))
+			return false;
+		if(bits == 0)
+			return false;
+		pos = end;
+		Emit(OpCode::Cuts, bits, depth+1);
+		return true;
+	}
+
+	/*depth is the number of values on the stack once op is done*/
+	void CutGate::Emit(OpCode code, uint64_t bits, int depth)
+	{
+		m_program.push_back({code, bits});
+		m_maxDepth = std::max(m_maxDepth, depth);
+	}
+
+}
@@ -0,0 +1,74 @@
+/*
+	CutGate.h
+	A boolean combination of the cuts of a cut list, i.e. protons&!deuterons or (ede|theta)&xavgRange, where each
+	name is the name of a cut in the list, Cut stands for every cut of the list at once, and ! binds tighter than &,
+	which binds tighter than |. A gate is compiled once against a CutHandler into a postfix program over the bits of
+	the mask from CutHandler::GetInsideMask, so every cut is tested once per event however many gates use it, and a
+	gate is then a few bit operations.
+*/
+#ifndef CUTGATE_H
+#define CUTGATE_H
+
+#include "CutHandler.h"
+
+namespace EventBuilder {
+
+	class CutGate
+	{
+	public:
+		CutGate();
+		bool Compile(const std::string& text, const CutHandler& cuts);
+		inline const std::string& GetText() const { return m_text; }
+
+		inline bool IsValid() const { return !m_program.empty(); }
+
+		/*An invalid gate (not compiled, or failed to compile) passes nothing*/
+		inline bool Evaluate(uint64_t insideMask) const
+		{
+			if(m_program.empty())
+				return false;
+			bool stack[s_maxDepth];
+			int top = 0;
+			for(const auto& op : m_program)
+			{
+				switch(op.code)
+				{
+					case OpCode::Cuts: stack[top++] = (insideMask & op.bits) == op.bits; break;
+					case OpCode::Not: stack[top-1] = !stack[top-1]; break;
+					case OpCode::And: top--; stack[top-1] = stack[top-1] && stack[top]; break;
+					case OpCode::Or: top--; stack[top-1] = stack[top-1] || stack[top]; break;
+				}
+			}
+			return stack[0];
+		}
+
+	private:
+		enum class OpCode
+		{
+			Cuts, //push whether every cut of bits is passed
+			Not,
+			And,
+			Or
+		};
+
+		struct Op
+		{
+			OpCode code;
+			uint64_t bits;
+		};
+
+		bool ParseOr(std::size_t& pos, int depth);
+		bool ParseAnd(std::size_t& pos, int depth);
+		bool ParseUnary(std::size_t& pos, int depth);
+		void Emit(OpCode code, uint64_t bits, int depth);
+
+		std::string m_text;
+		std::vector<Op> m_program;
+		const CutHandler* m_cuts; //only while compiling
+		int m_maxDepth; //deepest stack reached while compiling
+		static constexpr int s_maxDepth = 32; //stack entries of a gate
+	};
+
+}
+
+#endif
@@ -1,19 +1,18 @@
 #include "EventBuilder.h"
 #include "CutHandler.h"
+#include "EventVariables.h"
 
 namespace EventBuilder {
 	
 	CutHandler::CutHandler() :
-		validFlag(false)
+		m_rasterSize(0), validFlag(false)
 	 {
-		InitVariableMap();
 	 }
 	
 	CutHandler::CutHandler(const std::string& filename) :
-		validFlag(false)
+		m_rasterSize(0), validFlag(false)
 	{
 		SetCuts(filename);
-		InitVariableMap();
 	}
 	
 	CutHandler::~CutHandler() 
@@ -37,12 +36,13 @@ namespace EventBuilder {
 	
 		cut_array.clear();
 		file_array.clear();
+		m_compiled.clear();
 	
 		while(cutlist>>name) 
 		{
 			cutlist>>fname>>varx>>vary;
 			TFile* file = TFile::Open(fname.c_str(), "READ");
-			TCutG* cut = (TCutG*) file->Get("CUTG");
+			TCutG* cut = file != nullptr ? (TCutG*) file->Get("CUTG") : nullptr;
 			if(cut) 
 			{
 				cut->SetVarX(varx.c_str());
@@ -50,6 +50,13 @@ namespace EventBuilder {
 				cut->SetName(name.c_str());
 				cut_array.push_back(cut);
 				file_array.push_back(file);
+				m_compiled.emplace_back();
+				if(!CompileCut(cut, m_compiled.back()))
+				{
+					validFlag = false;
+					EVB_WARN("CutHandler::SetCuts has encountered unmapped variable names in cut {0} (x:{1}, y:{2}). Cuts ignored.", name, varx, vary);
+					return;
+				}
 			} 
 			else 
 			{
@@ -59,50 +66,182 @@ namespace EventBuilder {
 			}
 		}
 	
+		if(cut_array.size() > s_maxGateCuts)
+			EVB_WARN("Cut list {0} has {1} cuts; only the first {2} can be used as gates.", filename, cut_array.size(), s_maxGateCuts);
+
 		if(cut_array.size() > 0)
 			validFlag = true;
 		else
 			validFlag = false;
 	}
-	
-	/*
-		ADD MORE VARIABLES HERE!
-	*/
-	void CutHandler::InitVariableMap() 
+
+	/*Cells per axis of the masks of the cuts; 0 for none. Cuts already read are re-rastered.*/
+	void CutHandler::SetRasterSize(int cells)
 	{
-		varmap["x1"] = &m_event.x1;
-		varmap["x2"] = &m_event.x2;
-		varmap["xavg"] = &m_event.xavg;
-		varmap["scintLeft"] = &m_event.scintLeft;
-		varmap["anodeBack"]  = &m_event.anodeBack;
-		varmap["anodeFront"]  = &m_event.anodeFront;
-		varmap["cathode"] = &m_event.cathode;
-		varmap["delayBackRightE"] = &m_event.delayBackRightE;
+		m_rasterSize = cells > 0 ? cells : 0;
+		for(auto& compiled : m_compiled)
+			MakeRaster(compiled);
 	}
-	
-	bool CutHandler::IsInside(const ProcessedEvent* eaddress) 
+
+	/*Resolve the variables of a cut to offsets, and take the bounding box of its polygon*/
+	bool CutHandler::CompileCut(TCutG* cut, CompiledCut& compiled)
+	{
+		compiled.cut = cut;
+		if(!GetEventVariableOffset(cut->GetVarX(), compiled.offsetX) || !GetEventVariableOffset(cut->GetVarY(), compiled.offsetY))
+			return false;
+
+		int npoints = cut->GetN();
+		const double* xpoints = cut->GetX();
+		const double* ypoints = cut->GetY();
+		compiled.xmin = compiled.ymin = 1.0;
+		compiled.xmax = compiled.ymax = -1.0; //an empty box, inside of which nothing is
+		for(int i=0; i<npoints; i++)
+		{
+			if(i == 0 || xpoints[i] < compiled.xmin) compiled.xmin = xpoints[i];
+			if(i == 0 || xpoints[i] > compiled.xmax) compiled.xmax = xpoints[i];
+			if(i == 0 || ypoints[i] < compiled.ymin) compiled.ymin = ypoints[i];
+			if(i == 0 || ypoints[i] > compiled.ymax) compiled.ymax = ypoints[i];
+		}
+		MakeRaster(compiled);
+		return true;
+	}
+
+	/*
+		Mark every cell that an edge of the polygon passes through as Edge: row by row, the cells spanned by the part of
+		the edge within the row. Any other cell lies wholly on one side of the polygon, so its centre decides it.
+	*/
+	void CutHandler::MakeRaster(CompiledCut& compiled)
 	{
-		m_event = *eaddress;
-		std::string x, y;
-		for(unsigned int i=0; i<cut_array.size(); i++) 
+		compiled.raster.clear();
+		if(m_rasterSize == 0 || compiled.xmax <= compiled.xmin || compiled.ymax <= compiled.ymin)
+			return;
+
+		int n = m_rasterSize;
+		compiled.cellsPerX = n/(compiled.xmax - compiled.xmin);
+		compiled.cellsPerY = n/(compiled.ymax - compiled.ymin);
+		auto cellX = [&](double x) { return std::min(std::max(int((x - compiled.xmin)*compiled.cellsPerX), 0), n-1); };
+		auto cellY = [&](double y) { return std::min(std::max(int((y - compiled.ymin)*compiled.cellsPerY), 0), n-1); };
+
+		std::vector<uint8_t> raster(std::size_t(n)*n, Outside);
+		std::vector<bool> decided(raster.size(), false);
+		int npoints = compiled.cut->GetN();
+		const double* xpoints = compiled.cut->GetX();
+		const double* ypoints = compiled.cut->GetY();
+		for(int i=0; i<npoints; i++)
 		{
-			TCutG* cut = cut_array[i];
-			x = cut->GetVarX();
-			y = cut->GetVarY();
-			auto xentry = varmap.find(x);
-			auto yentry = varmap.find(y);
-			if(xentry == varmap.end() || yentry == varmap.end()) 
+			int next = (i+1) % npoints;
+			double xa = xpoints[i], ya = ypoints[i], xb = xpoints[next], yb = ypoints[next];
+			if(ya > yb)
 			{
-				EVB_WARN("Unmapped variable names at CutHandler::IsInside() (x:{0}, y:{1})! Cut not applied.", xentry->first, yentry->first);
-				return false;
+				std::swap(xa, xb);
+				std::swap(ya, yb);
+			}
+			int y0 = cellY(ya), y1 = cellY(yb);
+			for(int iy=y0; iy<=y1; iy++)
+			{
+				//x of the edge where it enters and leaves the row, widened to the cells either side of a cell boundary
+				double rowLow = std::max(ya, compiled.ymin + iy/compiled.cellsPerY);
+				double rowHigh = std::min(yb, compiled.ymin + (iy + 1)/compiled.cellsPerY);
+				double xlow = xa, xhigh = xb;
+				if(yb > ya)
+				{
+					xlow = xa + (xb - xa)*(rowLow - ya)/(yb - ya);
+					xhigh = xa + (xb - xa)*(rowHigh - ya)/(yb - ya);
+				}
+				int x0 = cellX(std::min(xlow, xhigh)), x1 = cellX(std::max(xlow, xhigh));
+				x0 = std::max(x0 - 1, 0);
+				x1 = std::min(x1 + 1, n-1);
+				for(int iyEdge=std::max(iy-1, 0); iyEdge<=std::min(iy+1, n-1); iyEdge++)
+					for(int ix=x0; ix<=x1; ix++)
+					{
+						raster[std::size_t(iyEdge)*n + ix] = Edge;
+						decided[std::size_t(iyEdge)*n + ix] = true;
+					}
+			}
+		}
+
+		for(int iy=0; iy<n; iy++)
+		{
+			double y = compiled.ymin + (iy + 0.5)/compiled.cellsPerY;
+			for(int ix=0; ix<n; ix++)
+			{
+				std::size_t cell = std::size_t(iy)*n + ix;
+				if(!decided[cell])
+					raster[cell] = compiled.cut->IsInside(compiled.xmin + (ix + 0.5)/compiled.cellsPerX, y) ? Inside : Outside;
 			}
+		}
+		compiled.raster = std::move(raster);
+	}
 	
-			if(!cut->IsInside(*(xentry->second), *(yentry->second)))
+	bool CutHandler::IsInsideCut(const CompiledCut& compiled, const ProcessedEvent& event) const
+	{
+		double x = ReadEventVariable(event, compiled.offsetX);
+		double y = ReadEventVariable(event, compiled.offsetY);
+		if(!(x >= compiled.xmin && x <= compiled.xmax && y >= compiled.ymin && y <= compiled.ymax)) //written so that NaN is rejected
+			return false;
+
+		if(!compiled.raster.empty())
+		{
+			int n = m_rasterSize;
+			int ix = std::min(int((x - compiled.xmin)*compiled.cellsPerX), n-1);
+			int iy = std::min(int((y - compiled.ymin)*compiled.cellsPerY), n-1);
+			uint8_t cell = compiled.raster[std::size_t(iy)*n + ix];
+			if(cell != Edge)
+				return cell == Inside;
+		}
+
+		return compiled.cut->IsInside(x, y);
+	}
+
+	/*Passes only events inside every cut*/
+	bool CutHandler::IsInside(const ProcessedEvent* eaddress) const
+	{
+		for(auto& compiled : m_compiled) 
+		{
+			if(!IsInsideCut(compiled, *eaddress))
 				return false;
-			
 		}
 	
 		return true;
 	}
 
-}
\ No newline at end of file
+	/*Bit i is set for an event inside the i-th cut of the list*/
+	uint64_t CutHandler::GetInsideMask(const ProcessedEvent* eaddress) const
+	{
+		uint64_t mask = 0;
+		std::size_t ncuts = std::min(m_compiled.size(), s_maxGateCuts);
+		for(std::size_t i=0; i<ncuts; i++)
+		{
+			if(IsInsideCut(m_compiled[i], *eaddress))
+				mask |= uint64_t(1) << i;
+		}
+		return mask;
+	}
+
+	/*Bit of the inside mask for the cut called name; false if there is no such cut, or it's past the mask*/
+	bool CutHandler::GetCutBit(const std::string& name, uint64_t& bit) const
+	{
+		if(!validFlag)
+			return false;
+		std::size_t ncuts = std::min(cut_array.size(), s_maxGateCuts);
+		for(std::size_t i=0; i<ncuts; i++)
+		{
+			if(name == cut_array[i]->GetName())
+			{
+				bit = uint64_t(1) << i;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	/*Bits of every cut of the inside mask; 0 with no (valid) cuts*/
+	uint64_t CutHandler::GetAllCutBits() const
+	{
+		if(!validFlag)
+			return 0;
+		std::size_t ncuts = std::min(cut_array.size(), s_maxGateCuts);
+		return ncuts == s_maxGateCuts ? ~uint64_t(0) : (uint64_t(1) << ncuts) - 1;
+	}
+
+}
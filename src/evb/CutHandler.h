@@ -2,29 +2,63 @@
 #define CUTHANDLER_H
 
 #include "../spsdict/DataStructs.h"
+#include <cstdint>
 
 namespace EventBuilder {
 	
+	/*
+		Applies the cuts of a cut list (an AND of every cut) to ProcessedEvents. Each cut is compiled when the list is
+		read: its variables resolved to field offsets (see EventVariables.h) and the bounding box of its polygon
+		taken, so an event is tested without copying it or looking anything up, and most events outside a cut are
+		rejected on the box alone. With a raster size set, each cut also gets a mask over its box of that many
+		cells per axis, marking cells wholly inside or outside the polygon; only events in cells an edge passes
+		through are tested against the polygon itself.
+		Each cut is also a gate of its own: GetInsideMask tests every cut of an event once, setting bit i for the i-th
+		cut passed, and CutGates combine the bits (see CutGate.h). Only the first 64 cuts of a list can be gates.
+	*/
 	class CutHandler {
 	public:
 		CutHandler();
 		CutHandler(const std::string& filename);
 		~CutHandler();
 		void SetCuts(const std::string& filename);
-		bool IsValid() { return validFlag; }
-		bool IsInside(const ProcessedEvent* eaddress);
+		void SetRasterSize(int cells);
+		bool IsValid() const { return validFlag; }
+		bool IsInside(const ProcessedEvent* eaddress) const;
+		uint64_t GetInsideMask(const ProcessedEvent* eaddress) const;
+		bool GetCutBit(const std::string& name, uint64_t& bit) const;
+		uint64_t GetAllCutBits() const;
 		std::vector<TCutG*> GetCuts() { return cut_array; }
 	
 	private:
-		void InitVariableMap();
+		enum RasterCell : uint8_t
+		{
+			Outside,
+			Inside,
+			Edge
+		};
+
+		struct CompiledCut
+		{
+			TCutG* cut;
+			std::size_t offsetX, offsetY; //into the ProcessedEvent
+			double xmin, xmax, ymin, ymax; //bounding box
+			double cellsPerX, cellsPerY; //raster cells per unit
+			std::vector<uint8_t> raster; //RasterCells, row (y) major; empty for no raster
+		};
+
+		bool CompileCut(TCutG* cut, CompiledCut& compiled);
+		bool IsInsideCut(const CompiledCut& compiled, const ProcessedEvent& event) const;
+		void MakeRaster(CompiledCut& compiled);
 	
 		std::vector<TCutG*> cut_array;
 		std::vector<TFile*> file_array;
-		std::unordered_map<std::string, double*> varmap;
+		std::vector<CompiledCut> m_compiled; //one per entry of cut_array
+		int m_rasterSize; //cells per axis; 0 for no raster
 		bool validFlag;
-		ProcessedEvent m_event;	
+		static constexpr std::size_t s_maxGateCuts = 64; //bits of the inside mask
 	};
 
 }
 
-#endif
\ No newline at end of file
+#endif
@@ -15,13 +15,17 @@
 #include "FastSort.h"
 #include "SFPAnalyzer.h"
 #include "SFPPlotter.h"
+#include <TSystem.h>
+#include <atomic>
+#include <future>
+#include <sstream>
 
 namespace EventBuilder {
 	
 	EVBApp::EVBApp() :
 		m_rmin(0), m_rmax(0), m_ZT(0), m_AT(0), m_ZP(0), m_AP(0), m_ZE(0), m_AE(0), m_ZR(0), m_AR(0),
 		m_B(0), m_Theta(0), m_BKE(0), m_progressFraction(0.1), m_workspace("none"), m_mapfile("none"), m_shiftfile("none"),
-		m_cutList("none"), m_scalerfile("none"), m_SlowWindow(0), m_FastWindowIonCh(0),m_FastWindowCEBRA(0) //, m_FastWindowSABRE(0)
+		m_cutList("none"), m_scalerfile("none"), m_readMode("Buffered"), m_archiveMode("Extract"), m_bufferBudget(0), m_threads(1), m_jobs(1), m_pipeline("Off"), m_mergeMode("Heap"), m_reorderDepth(0), m_externalSort(0), m_source("Binary"), m_histogramSpec("None"), m_cutRaster(0), m_multiOutputs("ConvertSlow,ConvertFastA"), m_trigger("None"), m_triggerLookback(0), m_SlowWindow(0), m_FastWindowIonCh(0),m_FastWindowCEBRA(0) //, m_FastWindowSABRE(0)
 	{
 		SetProgressCallbackFunc(BIND_PROGRESS_CALLBACK_FUNCTION(EVBApp::DefaultProgressCallback));
 	}
@@ -79,6 +83,94 @@ namespace EventBuilder {
 		std::getline(input, junk);
 		input>>junk>>m_rmin;
 		input>>junk>>m_rmax;
+
+		//Optional performance section. Older config files stop at the run information, so every
+		//entry here is keyed by name and falls back to its default when absent.
+		while(input>>junk)
+		{
+			if(junk == "ReadMode:")
+			{
+				input>>junk;
+				SetReadMode(junk);
+			}
+			else if(junk == "ArchiveMode:")
+			{
+				input>>junk;
+				SetArchiveMode(junk);
+			}
+			else if(junk == "BufferBudget(MB):")
+			{
+				int megabytes;
+				input>>megabytes;
+				SetBufferBudget(megabytes);
+			}
+			else if(junk == "Threads:")
+			{
+				int threads;
+				input>>threads;
+				SetThreads(threads);
+			}
+			else if(junk == "Jobs:")
+			{
+				int jobs;
+				input>>jobs;
+				SetJobs(jobs);
+			}
+			else if(junk == "Pipeline:")
+			{
+				input>>junk;
+				SetPipeline(junk);
+			}
+			else if(junk == "MergeMode:")
+			{
+				input>>junk;
+				SetMergeMode(junk);
+			}
+			else if(junk == "ReorderDepth:")
+			{
+				int depth;
+				input>>depth;
+				SetReorderDepth(depth);
+			}
+			else if(junk == "ExternalSort(MB):")
+			{
+				int megabytes;
+				input>>megabytes;
+				SetExternalSort(megabytes);
+			}
+			else if(junk == "Source:")
+			{
+				input>>junk;
+				SetSource(junk);
+			}
+			else if(junk == "HistogramSpec:")
+			{
+				input>>junk;
+				SetHistogramSpec(junk);
+			}
+			else if(junk == "CutRaster:")
+			{
+				int cells;
+				input>>cells;
+				SetCutRaster(cells);
+			}
+			else if(junk == "MultiOutputs:")
+			{
+				input>>junk;
+				SetMultiOutputs(junk);
+			}
+			else if(junk == "Trigger:")
+			{
+				input>>junk;
+				SetTrigger(junk);
+			}
+			else if(junk == "TriggerLookback(ps):")
+			{
+				double lookback;
+				input>>lookback;
+				SetTriggerLookback(lookback);
+			}
+		}
 	
 		input.close();
 	
@@ -129,6 +221,23 @@ namespace EventBuilder {
 		output<<"MinRun: "<<m_rmin<<std::endl;
 		output<<"MaxRun: "<<m_rmax<<std::endl;
 		output<<"-------------------------------"<<std::endl;
+		output<<"------Performance Options------"<<std::endl;
+		output<<"ReadMode: "<<m_readMode<<std::endl;
+		output<<"ArchiveMode: "<<m_archiveMode<<std::endl;
+		output<<"BufferBudget(MB): "<<m_bufferBudget<<std::endl;
+		output<<"Threads: "<<m_threads<<std::endl;
+		output<<"Jobs: "<<m_jobs<<std::endl;
+		output<<"Pipeline: "<<m_pipeline<<std::endl;
+		output<<"MergeMode: "<<m_mergeMode<<std::endl;
+		output<<"ReorderDepth: "<<m_reorderDepth<<std::endl;
+		output<<"ExternalSort(MB): "<<m_externalSort<<std::endl;
+		output<<"Source: "<<m_source<<std::endl;
+		output<<"HistogramSpec: "<<m_histogramSpec<<std::endl;
+		output<<"CutRaster: "<<m_cutRaster<<std::endl;
+		output<<"MultiOutputs: "<<m_multiOutputs<<std::endl;
+		output<<"Trigger: "<<m_trigger<<std::endl;
+		output<<"TriggerLookback(ps): "<<m_triggerLookback<<std::endl;
+		output<<"-------------------------------"<<std::endl;
 	
 		output.close();
 	
@@ -136,6 +245,172 @@ namespace EventBuilder {
 	
 	}
 	
+	/*Apply the settings shared by every conversion to a CompassRun*/
+	void EVBApp::ConfigureRun(CompassRun& converter)
+	{
+		converter.SetShiftMap(m_shiftfile);
+		converter.SetScalerInput(m_scalerfile);
+		converter.SetProgressCallbackFunc(m_progressCallback);
+		converter.SetProgressFraction(m_progressFraction);
+		if(m_readMode == "MemoryMapped")
+			converter.SetReadMode(CompassFile::ReadMode::MemoryMapped);
+		else if(m_readMode == "Prefetch")
+			converter.SetReadMode(CompassFile::ReadMode::Prefetch);
+		else
+			converter.SetReadMode(CompassFile::ReadMode::Buffered);
+		converter.SetBufferBudget(uint64_t(m_bufferBudget)*1024*1024);
+		converter.SetThreads(m_threads);
+		converter.SetPipeline(m_pipeline == "On");
+		converter.SetReorderDepth(m_reorderDepth);
+		converter.SetExternalSort(uint64_t(m_externalSort)*1024*1024);
+		converter.SetMergeMode(m_mergeMode == "Block" ? HitMerger::MergeMode::Block : HitMerger::MergeMode::Heap);
+		converter.SetTrigger(m_trigger == "None" ? DetAttribute::NoneAttr : GetFocalPlaneAttribute(m_trigger), m_triggerLookback);
+	}
+	
+	/*
+		Make the binaries of a run available to the converter. Extract mode unpacks the archive into the
+		temp_binary directory with tar; Stream mode hands the archive to the CompassRun, which decompresses
+		it in memory. A raw_root input (rawInput) is handed to the CompassRun as is.
+	*/
+	void EVBApp::UnpackRun(CompassRun& converter, const std::string& binfile, const std::string& unpack_dir, bool rawInput)
+	{
+		if(rawInput)
+		{
+			converter.SetRawInput(binfile);
+			return;
+		}
+
+		converter.SetRawInput("");
+		if(m_archiveMode == "Stream")
+		{
+			converter.SetArchive(binfile);
+			return;
+		}
+
+		converter.SetArchive("");
+		std::string unpack_command = "tar -xzf "+binfile+" --directory "+unpack_dir;
+		int sys_return = system(unpack_command.c_str());
+		if(sys_return != 0)
+			EVB_WARN("Unpacking of archive {0} returned non-zero status {1}.", binfile, sys_return);
+	}
+
+	void EVBApp::CleanupRun(const std::string& unpack_dir, bool rawInput)
+	{
+		if(rawInput || m_archiveMode == "Stream")
+			return;
+
+		std::string wipe_command = "rm -r "+unpack_dir+"*.BIN";
+		int sys_return = system(wipe_command.c_str());
+		(void) sys_return;
+	}
+	
+	/*
+		Convert every run in the range which has an archive, with the outputs named outprefix+N.root. Runs are
+		converted one after another, or, with more than one job, by a pool of m_jobs workers. Each worker has its
+		own CompassRun and its own unpack directory (temp_binary/job_N/), so extracted binaries never collide.
+		Progress is then counted in finished runs, and reported from this (the calling) thread.
+		With rawInput the grabbed files are raw_root files rather than archives (see SearchRunInputs).
+		Returns the number of runs converted.
+	*/
+	int EVBApp::ConvertRuns(const std::string& outprefix, const RunConversion& convert, bool rawInput)
+	{
+		std::string unpack_dir = m_workspace+"/temp_binary/";
+
+		std::vector<std::pair<int, std::string>> runs; //run number, archive
+		for(int i=m_rmin; i<=m_rmax; i++) 
+		{
+			std::string binfile = grabber.GrabFile(i);
+			if(binfile != "") 
+				runs.emplace_back(i, binfile);
+		}
+
+		EVB_INFO("Beginning conversion...");
+		if(m_jobs == 1 || runs.size() < 2)
+		{
+			CompassRun converter(unpack_dir);
+			ConfigureRun(converter);
+			for(auto& run : runs)
+			{
+				converter.SetRunNumber(run.first);
+				EVB_INFO("Converting file {0}...", run.second);
+				UnpackRun(converter, run.second, unpack_dir, rawInput);
+				convert(converter, outprefix + std::to_string(run.first) + ".root");
+				CleanupRun(unpack_dir, rawInput);
+			}
+			return runs.size();
+		}
+
+		int njobs = std::min<int>(m_jobs, runs.size());
+		EVB_INFO("Converting {0} runs with {1} jobs.", runs.size(), njobs);
+		std::vector<std::string> job_dirs;
+		for(int i=0; i<njobs; i++)
+		{
+			job_dirs.push_back(unpack_dir + "job_" + std::to_string(i) + "/");
+			gSystem->mkdir(job_dirs.back().c_str(), kTRUE);
+		}
+
+		ROOT::EnableThreadSafety();
+		std::atomic<std::size_t> nextRun(0);
+		std::atomic<long> finished(0);
+		auto worker = [&](int job)
+		{
+			const std::string& job_dir = job_dirs[job];
+			CompassRun converter(job_dir);
+			ConfigureRun(converter);
+			converter.SetProgressCallbackFunc([](long curVal, long totalVal) {});
+			std::size_t index;
+			while((index = nextRun++) < runs.size())
+			{
+				auto& run = runs[index];
+				converter.SetRunNumber(run.first);
+				EVB_INFO("Converting file {0}...", run.second);
+				UnpackRun(converter, run.second, job_dir, rawInput);
+				convert(converter, outprefix + std::to_string(run.first) + ".root");
+				CleanupRun(job_dir, rawInput);
+				finished++;
+			}
+		};
+
+		std::vector<std::future<void>> workers;
+		for(int i=0; i<njobs; i++)
+			workers.push_back(std::async(std::launch::async, worker, i));
+
+		long reported = 0;
+		for(auto& job : workers)
+		{
+			while(job.wait_for(std::chrono::milliseconds(200)) != std::future_status::ready)
+			{
+				long done = finished;
+				if(done != reported)
+				{
+					reported = done;
+					m_progressCallback(done, runs.size());
+				}
+			}
+		}
+		m_progressCallback(finished, runs.size());
+
+		for(auto& job_dir : job_dirs)
+			gSystem->Unlink(job_dir.c_str());
+
+		return runs.size();
+	}
+
+	/*
+		Point the grabber at the inputs of the event building conversions over the run range: the binary archives,
+		or, with the RawRoot source, the raw_root files written by Convert2RawRoot. Returns true for raw_root.
+	*/
+	bool EVBApp::SearchRunInputs()
+	{
+		if(m_source == "RawRoot")
+		{
+			grabber.SetSearchParams(m_workspace+"/raw_root/", "compass_run_", ".root", m_rmin, m_rmax);
+			return true;
+		}
+		grabber.SetSearchParams(m_workspace+"/raw_binary/", "", ".tar.gz", m_rmin, m_rmax);
+		return false;
+	}
+
 	void EVBApp::PlotHistograms() 
 	{
 		std::string analyze_dir = m_workspace+"/analyzed/";
@@ -143,7 +418,11 @@ namespace EventBuilder {
 		SFPPlotter grammer;
 		grammer.SetProgressCallbackFunc(m_progressCallback);
 		grammer.SetProgressFraction(m_progressFraction);
+		grammer.SetThreads(m_threads);
+		grammer.SetCutRaster(m_cutRaster);
 		grammer.ApplyCutlist(m_cutList);
+		if(m_histogramSpec != "None" && !grammer.ReadHistogramSpec(m_histogramSpec))
+			EVB_WARN("No histograms read from spec file {0}; plotting the built in histograms.", m_histogramSpec);
 		EVB_INFO("Generating histograms from analyzed runs [{0}, {1}] with Cut List {2}...", m_rmin, m_rmax, m_cutList);
 		if(m_cebragainfile!="None"){
 		  grammer.ReadCebraGains(m_cebragainfile);
@@ -165,40 +444,16 @@ namespace EventBuilder {
 	
 	void EVBApp::Convert2RawRoot() 
 	{
-		int sys_return;
 		std::string rawroot_dir = m_workspace+"/raw_root/";
-		std::string unpack_dir = m_workspace+"/temp_binary/";
 		std::string binary_dir = m_workspace+"/raw_binary/";
 		EVB_INFO("Converting binary archives to ROOT files over run range [{0}, {1}]",m_rmin,m_rmax);
 	
 		grabber.SetSearchParams(binary_dir, "", ".tar.gz",0,1000);
 	
-		std::string rawfile, binfile;
-		std::string unpack_command, wipe_command;
-	
-		CompassRun converter(unpack_dir);
-		converter.SetShiftMap(m_shiftfile);
-		converter.SetScalerInput(m_scalerfile);
-		converter.SetProgressCallbackFunc(m_progressCallback);
-		converter.SetProgressFraction(m_progressFraction);
-	
-		EVB_INFO("Beginning conversion...");
-		for(int i=m_rmin; i<=m_rmax; i++) 
+		ConvertRuns(rawroot_dir + "compass_run_", [&](CompassRun& converter, const std::string& rawfile)
 		{
-			binfile = grabber.GrabFile(i);
-			if(binfile == "") 
-				continue;
-			converter.SetRunNumber(i);
-			EVB_INFO("Converting file {0}...", binfile);
-			rawfile = rawroot_dir + "compass_run_"+ std::to_string(i) + ".root";
-			unpack_command = "tar -xzf "+binfile+" --directory "+unpack_dir;
-			wipe_command = "rm -r "+unpack_dir+"*.BIN";
-	
-			sys_return = system(unpack_command.c_str());
 			converter.Convert2RawRoot(rawfile);
-			sys_return = system(wipe_command.c_str());
-	
-		}
+		});
 		EVB_INFO("Conversion complete.");
 	}
 	
@@ -222,199 +477,121 @@ namespace EventBuilder {
 	
 	void EVBApp::Convert2SortedRoot() 
 	{
-		int sys_return;
 		std::string sortroot_dir = m_workspace+"/sorted/";
-		std::string unpack_dir = m_workspace+"/temp_binary/";
-		std::string binary_dir = m_workspace+"/raw_binary/";
-		EVB_INFO("Converting binary archives to event built ROOT files over run range [{0}, {1}]",m_rmin,m_rmax);
-	
-		grabber.SetSearchParams(binary_dir,"",".tar.gz",m_rmin,m_rmax);
+		EVB_INFO("Converting {0} to event built ROOT files over run range [{1}, {2}]", m_source == "RawRoot" ? "raw_root files" : "binary archives", m_rmin, m_rmax);
 	
-		std::string sortfile, binfile;
-		std::string unpack_command, wipe_command;
+		bool rawInput = SearchRunInputs();
 	
-		CompassRun converter(unpack_dir);
-		converter.SetShiftMap(m_shiftfile);
-		converter.SetScalerInput(m_scalerfile);
-		converter.SetProgressCallbackFunc(m_progressCallback);
-		converter.SetProgressFraction(m_progressFraction);
-	
-		EVB_INFO("Beginning conversion...");
-	
-		int count=0;
-		for(int i=m_rmin; i<= m_rmax; i++) 
+		int count = ConvertRuns(sortroot_dir + "run_", [&](CompassRun& converter, const std::string& sortfile)
 		{
-			binfile = grabber.GrabFile(i);
-			if(binfile == "") 
-				continue;
-			converter.SetRunNumber(i);
-			EVB_INFO("Converting file {0}...",binfile);
-	
-			sortfile = sortroot_dir +"run_"+std::to_string(i)+ ".root";
-			unpack_command = "tar -xzf "+binfile+" --directory "+unpack_dir;
-			wipe_command = "rm -r "+unpack_dir+"*.BIN";
-	
-			sys_return = system(unpack_command.c_str());
 			converter.Convert2SortedRoot(sortfile, m_mapfile, m_SlowWindow);
-			sys_return = system(wipe_command.c_str());
-			count++;
-		}
+		}, rawInput);
 		if(count==0)
-			EVB_WARN("Conversion failed, no archives were found!");
+			EVB_WARN("Conversion failed, no input files were found!");
 		else
 			EVB_INFO("Conversion complete.");
 	}
 	
-	void EVBApp::Convert2FastSortedRoot() {
-		int sys_return;
+	void EVBApp::Convert2FastSortedRoot() 
+	{
 		std::string sortroot_dir = m_workspace+"/fast/";
-		std::string unpack_dir = m_workspace+"/temp_binary/";
-		std::string binary_dir = m_workspace+"/raw_binary/";
-		EVB_INFO("Converting binary archives to fast event built ROOT files over run range [{0}, {1}]",m_rmin,m_rmax);
+		EVB_INFO("Converting {0} to fast event built ROOT files over run range [{1}, {2}]", m_source == "RawRoot" ? "raw_root files" : "binary archives", m_rmin, m_rmax);
 	
-		grabber.SetSearchParams(binary_dir,"",".tar.gz",m_rmin,m_rmax);
+		bool rawInput = SearchRunInputs();
 	
-		std::string sortfile, binfile;
-		std::string unpack_command, wipe_command;
-	
-		CompassRun converter(unpack_dir);
-		converter.SetShiftMap(m_shiftfile);
-		converter.SetScalerInput(m_scalerfile);
-		converter.SetProgressCallbackFunc(m_progressCallback);
-		converter.SetProgressFraction(m_progressFraction);
-	
-		EVB_INFO("Beginning conversion...");
-		int count=0;
-		for(int i=m_rmin; i<=m_rmax; i++) 
+		int count = ConvertRuns(sortroot_dir + "run_", [&](CompassRun& converter, const std::string& sortfile)
 		{
-			binfile = grabber.GrabFile(i);
-			if(binfile == "") 
-				continue;
-			converter.SetRunNumber(i);
-			EVB_INFO("Converting file {0}...",binfile);
-	
-			sortfile = sortroot_dir + "run_" + std::to_string(i) + ".root";
-			unpack_command = "tar -xzf "+binfile+" --directory "+unpack_dir;
-			wipe_command = "rm -r "+unpack_dir+"*.BIN";
-	
-			sys_return = system(unpack_command.c_str());
 			converter.Convert2FastSortedRoot(sortfile, m_mapfile, m_SlowWindow, m_FastWindowCEBRA /*, m_FastWindowSABRE*/, m_FastWindowIonCh);
-			sys_return = system(wipe_command.c_str());
-			count++;
-		}
+		}, rawInput);
 		if(count==0)
-			EVB_WARN("Conversion failed, no archives were found!");
+			EVB_WARN("Conversion failed, no input files were found!");
 		else
 			EVB_INFO("Conversion complete.");
 	}
 	
-	void EVBApp::Convert2SlowAnalyzedRoot() {
-		int sys_return;
+	void EVBApp::Convert2SlowAnalyzedRoot() 
+	{
 		std::string sortroot_dir = m_workspace+"/analyzed/";
-		std::string unpack_dir = m_workspace+"/temp_binary/";
-		std::string binary_dir = m_workspace+"/raw_binary/";
-		EVB_INFO("Converting binary archives to analyzed event built ROOT files over run range [{0}, {1}]",m_rmin,m_rmax);
-
-		grabber.SetSearchParams(binary_dir,"",".tar.gz",m_rmin, m_rmax);
+		EVB_INFO("Converting {0} to analyzed event built ROOT files over run range [{1}, {2}]", m_source == "RawRoot" ? "raw_root files" : "binary archives", m_rmin, m_rmax);
 	
-		std::string sortfile, binfile;
-		std::string unpack_command, wipe_command;
-	
-		CompassRun converter(unpack_dir);
-		converter.SetShiftMap(m_shiftfile);
-		converter.SetScalerInput(m_scalerfile);
-		converter.SetProgressCallbackFunc(m_progressCallback);
-		converter.SetProgressFraction(m_progressFraction);
+		bool rawInput = SearchRunInputs();
 	
-		EVB_INFO("Beginning conversion...");
-		int count=0;
-		for(int i=m_rmin; i<=m_rmax; i++) 
+		int count = ConvertRuns(sortroot_dir + "run_", [&](CompassRun& converter, const std::string& sortfile)
 		{
-			binfile = grabber.GrabFile(i);
-			if(binfile == "") 
-				continue;
-			converter.SetRunNumber(i);
-			EVB_INFO("Converting file {0}...",binfile);
-	
-			sortfile = sortroot_dir + "run_" + std::to_string(i) + ".root";
-			unpack_command = "tar -xzf "+binfile+" --directory "+unpack_dir;
-			wipe_command = "rm -r "+unpack_dir+"*.BIN";
-	
-			sys_return = system(unpack_command.c_str());
 			converter.Convert2SlowAnalyzedRoot(sortfile, m_mapfile, m_SlowWindow, m_ZT, m_AT, m_ZP, m_AP, m_ZE, m_AE, m_BKE, m_B, m_Theta);
-			sys_return = system(wipe_command.c_str());
-			count++;
-		}
+		}, rawInput);
 		if(count==0)
-			EVB_WARN("Conversion failed, no archives were found!");
+			EVB_WARN("Conversion failed, no input files were found!");
 		else
 			EVB_INFO("Conversion complete.");
 	}
 	
 	void EVBApp::Convert2FastAnalyzedRoot() 
 	{
-		int sys_return;
 		std::string sortroot_dir = m_workspace+"/analyzed/";
-		std::string unpack_dir = m_workspace+"/temp_binary/";
-		std::string binary_dir = m_workspace+"/raw_binary/";
-		EVB_INFO("Converting binary archives to analyzed fast event built ROOT files over run range [{0}, {1}]",m_rmin,m_rmax);
-		
-		grabber.SetSearchParams(binary_dir,"",".tar.gz",m_rmin,m_rmax);
-	
-		std::string sortfile, binfile;
-		std::string unpack_command, wipe_command;
+		EVB_INFO("Converting {0} to analyzed fast event built ROOT files over run range [{1}, {2}]", m_source == "RawRoot" ? "raw_root files" : "binary archives", m_rmin, m_rmax);
 	
-		CompassRun converter(unpack_dir);
-		converter.SetShiftMap(m_shiftfile);
-		converter.SetScalerInput(m_scalerfile);
-		converter.SetProgressCallbackFunc(m_progressCallback);
-		converter.SetProgressFraction(m_progressFraction);
+		bool rawInput = SearchRunInputs();
 	
-		EVB_INFO("Beginning conversion...");
-		int count=0;
-		for(int i=m_rmin; i<=m_rmax; i++) 
+		int count = ConvertRuns(sortroot_dir + "run_", [&](CompassRun& converter, const std::string& sortfile)
 		{
-			binfile = grabber.GrabFile(i);
-			if(binfile == "") 
-				continue;
-			converter.SetRunNumber(i);
-			EVB_INFO("Converting file {0}...",binfile);
-	
-			sortfile = sortroot_dir + "run_" + std::to_string(i) + ".root";
-			unpack_command = "tar -xzf "+binfile+" --directory "+unpack_dir;
-			wipe_command = "rm -r "+unpack_dir+"*.BIN";
-	
-			sys_return = system(unpack_command.c_str());
 			converter.Convert2FastAnalyzedRoot(sortfile, m_mapfile, m_SlowWindow, m_FastWindowCEBRA,/* m_FastWindowSABRE,*/ m_FastWindowIonCh, m_ZT, m_AT, m_ZP, m_AP, m_ZE, m_AE, m_BKE, m_B, m_Theta);
-			sys_return = system(wipe_command.c_str());
-			count++;
-		}
+		}, rawInput);
 		if(count==0)
-			EVB_WARN("Conversion failed, no archives were found!");
+			EVB_WARN("Conversion failed, no input files were found!");
 		else
 			EVB_INFO("Conversion complete.");
 	}
 	
-	bool EVBApp::SetKinematicParameters(int zt, int at, int zp, int ap, int ze, int ae, double b, double theta, double bke) 
+	/*
+		Write the outputs of several conversions (m_multiOutputs) from one pass over each archive. The outputs are
+		named and placed exactly as by the individual conversions.
+	*/
+	void EVBApp::Convert2MultiRoot()
 	{
-	
-		if((at + ap - ae) < 0 || (zt + zp - ze) < 0) 
+		EVB_INFO("Converting {0} to {1} ROOT files over run range [{2}, {3}]", m_source == "RawRoot" ? "raw_root files" : "binary archives", m_multiOutputs, m_rmin, m_rmax);
+
+		bool rawInput = SearchRunInputs();
+
+		std::stringstream list(m_multiOutputs);
+		std::string operation;
+		std::vector<std::string> operations;
+		while(std::getline(list, operation, ','))
 		{
-			EVB_WARN("Invalid kinematic parameters, nucleon number not conserved! Parameters not set");
-			return false;
+			if(rawInput && operation == "Convert")
+			{
+				EVB_WARN("Convert output skipped, as the raw_root files are the input.");
+				continue;
+			}
+			operations.push_back(operation);
 		}
-		m_ZT = zt; m_AT = at; m_ZP = zp; m_AP = ap; m_ZE = ze; m_AE = ae;
-		m_B = b; m_Theta = theta; m_BKE = bke;
-	
-		m_ZR = (zt + zp - ze);
-		m_AR = (at + ap - ae);
 
-		EVB_TRACE("Kinematic paramters updated.");
-	
-		return true;
+		//With no prefix, the conversion is handed the bare N.root, and prefixes it for each output
+		int count = ConvertRuns("", [&](CompassRun& converter, const std::string& runfile)
+		{
+			RunOutputs outputs;
+			for(auto& entry : operations)
+			{
+				if(entry == "Convert")
+					outputs.raw = m_workspace + "/raw_root/compass_run_" + runfile;
+				else if(entry == "ConvertSlow")
+					outputs.sorted = m_workspace + "/sorted/run_" + runfile;
+				else if(entry == "ConvertFast")
+					outputs.fast = m_workspace + "/fast/run_" + runfile;
+				else if(entry == "ConvertSlowA" || entry == "ConvertFastA")
+				{
+					outputs.analyzed = m_workspace + "/analyzed/run_" + runfile;
+					outputs.analyzeFast = entry == "ConvertFastA";
+				}
+			}
+			converter.Convert2MultiRoot(outputs, m_mapfile, m_SlowWindow, m_FastWindowCEBRA, m_FastWindowIonCh, m_ZT, m_AT, m_ZP, m_AP, m_ZE, m_AE, m_BKE, m_B, m_Theta);
+		}, rawInput);
+		if(count==0)
+			EVB_WARN("Conversion failed, no input files were found!");
+		else
+			EVB_INFO("Conversion complete.");
 	}
-
-
+	
 	void EVBApp::SetRunRange(int rmin, int rmax) { EVB_TRACE("Min Run, max run set to [{0}, {1}]", rmin, rmax); m_rmin = rmin; m_rmax = rmax; }
 	void EVBApp::SetWorkDirectory(const std::string& fullpath) { EVB_TRACE("Workspace set to {0}", fullpath); m_workspace = fullpath; }
 	void EVBApp::SetChannelMap(const std::string& name) { EVB_TRACE("Channel map set to {0}",name); m_mapfile = name; }
@@ -425,5 +602,174 @@ namespace EventBuilder {
 	//void EVBApp::SetFastWindowSABRE(double window) { EVB_TRACE("Fast Coinc. Window SABRE set to {0}",window); m_FastWindowSABRE = window; }
 	void EVBApp::SetCutList(const std::string& name) { EVB_TRACE("Cut List set  to {0}", name); m_cutList = name; }
 	void EVBApp::SetScalerFile(const std::string& fullpath) { EVB_TRACE("Scaler file set to {0}", fullpath); m_scalerfile = fullpath; }
+	void EVBApp::SetHistogramSpec(const std::string& fullpath) { EVB_TRACE("Histogram spec file set to {0}", fullpath); m_histogramSpec = fullpath; }
+
+	void EVBApp::SetReadMode(const std::string& mode)
+	{
+		if(mode != "Buffered" && mode != "MemoryMapped" && mode != "Prefetch")
+		{
+			EVB_WARN("Unrecognized read mode {0}; options are Buffered, MemoryMapped, or Prefetch. Read mode unchanged ({1}).", mode, m_readMode);
+			return;
+		}
+		EVB_TRACE("Read mode set to {0}", mode);
+		m_readMode = mode;
+	}
+
+	void EVBApp::SetBufferBudget(int megabytes)
+	{
+		if(megabytes < 0)
+		{
+			EVB_WARN("Invalid buffer budget {0} MB; must be at least 0. Buffer budget unchanged ({1} MB).", megabytes, m_bufferBudget);
+			return;
+		}
+		EVB_TRACE("Buffer budget set to {0} MB", megabytes);
+		m_bufferBudget = megabytes;
+	}
+
+	void EVBApp::SetThreads(int n)
+	{
+		if(n < 1)
+		{
+			EVB_WARN("Invalid number of threads {0}; must be at least 1. Threads unchanged ({1}).", n, m_threads);
+			return;
+		}
+		EVB_TRACE("Threads set to {0}", n);
+		m_threads = n;
+	}
+
+	void EVBApp::SetJobs(int n)
+	{
+		if(n < 1)
+		{
+			EVB_WARN("Invalid number of jobs {0}; must be at least 1. Jobs unchanged ({1}).", n, m_jobs);
+			return;
+		}
+		EVB_TRACE("Jobs set to {0}", n);
+		m_jobs = n;
+	}
+
+	void EVBApp::SetArchiveMode(const std::string& mode)
+	{
+		if(mode != "Extract" && mode != "Stream")
+		{
+			EVB_WARN("Unrecognized archive mode {0}; options are Extract or Stream. Archive mode unchanged ({1}).", mode, m_archiveMode);
+			return;
+		}
+		EVB_TRACE("Archive mode set to {0}", mode);
+		m_archiveMode = mode;
+	}
+
+	void EVBApp::SetMultiOutputs(const std::string& list)
+	{
+		std::stringstream stream(list);
+		std::string operation;
+		int nanalyzed = 0, noutputs = 0;
+		while(std::getline(stream, operation, ','))
+		{
+			if(operation != "Convert" && operation != "ConvertSlow" && operation != "ConvertFast" && operation != "ConvertSlowA" && operation != "ConvertFastA")
+			{
+				EVB_WARN("Unrecognized multi output {0}; options are Convert, ConvertSlow, ConvertFast, ConvertSlowA, or ConvertFastA. Multi outputs unchanged ({1}).", operation, m_multiOutputs);
+				return;
+			}
+			if(operation == "ConvertSlowA" || operation == "ConvertFastA")
+				nanalyzed++;
+			noutputs++;
+		}
+		if(noutputs == 0 || nanalyzed > 1)
+		{
+			EVB_WARN("Invalid multi outputs {0}; need at least one output, and at most one of ConvertSlowA and ConvertFastA (they share the analyzed directory). Multi outputs unchanged ({1}).", list, m_multiOutputs);
+			return;
+		}
+		EVB_TRACE("Multi outputs set to {0}", list);
+		m_multiOutputs = list;
+	}
+
+	void EVBApp::SetPipeline(const std::string& mode)
+	{
+		if(mode != "On" && mode != "Off")
+		{
+			EVB_WARN("Unrecognized pipeline option {0}; options are On or Off. Pipeline unchanged ({1}).", mode, m_pipeline);
+			return;
+		}
+		EVB_TRACE("Pipeline set to {0}", mode);
+		m_pipeline = mode;
+	}
+
+	void EVBApp::SetMergeMode(const std::string& mode)
+	{
+		if(mode != "Heap" && mode != "Block")
+		{
+			EVB_WARN("Unrecognized merge mode {0}; options are Heap or Block. Merge mode unchanged ({1}).", mode, m_mergeMode);
+			return;
+		}
+		EVB_TRACE("Merge mode set to {0}", mode);
+		m_mergeMode = mode;
+	}
+
+	void EVBApp::SetReorderDepth(int depth)
+	{
+		if(depth < 0 || std::size_t(depth) > CompassFile::GetMaxReorderDepth())
+		{
+			EVB_WARN("Invalid reorder depth {0}; must be from 0 to {1}. Reorder depth unchanged ({2}).", depth, CompassFile::GetMaxReorderDepth(), m_reorderDepth);
+			return;
+		}
+		EVB_TRACE("Reorder depth set to {0}", depth);
+		m_reorderDepth = depth;
+	}
+
+	void EVBApp::SetCutRaster(int cells)
+	{
+		if(cells < 0 || cells > s_maxCutRaster)
+		{
+			EVB_WARN("Invalid cut raster size {0}; must be from 0 to {1}. Cut raster size unchanged ({2}).", cells, s_maxCutRaster, m_cutRaster);
+			return;
+		}
+		EVB_TRACE("Cut raster size set to {0}", cells);
+		m_cutRaster = cells;
+	}
+
+	void EVBApp::SetExternalSort(int megabytes)
+	{
+		if(megabytes < 0)
+		{
+			EVB_WARN("Invalid external sort memory {0} MB; must not be negative. External sort unchanged ({1} MB).", megabytes, m_externalSort);
+			return;
+		}
+		EVB_TRACE("External sort memory set to {0} MB", megabytes);
+		m_externalSort = megabytes;
+	}
+
+	void EVBApp::SetSource(const std::string& source)
+	{
+		if(source != "Binary" && source != "RawRoot")
+		{
+			EVB_WARN("Unrecognized source {0}; options are Binary or RawRoot. Source unchanged ({1}).", source, m_source);
+			return;
+		}
+		EVB_TRACE("Source set to {0}", source);
+		m_source = source;
+	}
+
+	void EVBApp::SetTrigger(const std::string& partname)
+	{
+		if(partname != "None" && GetFocalPlaneAttribute(partname) == DetAttribute::NoneAttr)
+		{
+			EVB_WARN("Unrecognized trigger {0}; options are None or a focal plane part of the channel map (i.e. SCINTLEFT). Trigger unchanged ({1}).", partname, m_trigger);
+			return;
+		}
+		EVB_TRACE("Trigger set to {0}", partname);
+		m_trigger = partname;
+	}
+
+	void EVBApp::SetTriggerLookback(double lookback)
+	{
+		if(lookback < 0.0)
+		{
+			EVB_WARN("Invalid trigger lookback {0}; must not be negative. Trigger lookback unchanged ({1}).", lookback, m_triggerLookback);
+			return;
+		}
+		EVB_TRACE("Trigger lookback set to {0}", lookback);
+		m_triggerLookback = lookback;
+	}
 
 }
@@ -13,6 +13,8 @@
 #include "ProgressCallback.h"
 
 namespace EventBuilder {
+
+	class CompassRun;
 	
 	class EVBApp {
 	public:
@@ -30,6 +32,7 @@ namespace EventBuilder {
 		void Convert2RawRoot();
 		void Convert2SlowAnalyzedRoot();
 		void Convert2FastAnalyzedRoot();
+		void Convert2MultiRoot();
 	
 		void SetRunRange(int rmin, int rmax);
 		void SetWorkDirectory(const std::string& fullpath);
@@ -41,6 +44,21 @@ namespace EventBuilder {
 	//	void SetFastWindowSABRE(double window);
 		void SetCutList(const std::string& name);
 		void SetScalerFile(const std::string& fullpath);
+		void SetReadMode(const std::string& mode);
+		void SetArchiveMode(const std::string& mode);
+		void SetBufferBudget(int megabytes);
+		void SetThreads(int n);
+		void SetJobs(int n);
+		void SetPipeline(const std::string& mode);
+		void SetMergeMode(const std::string& mode);
+		void SetReorderDepth(int depth);
+		void SetExternalSort(int megabytes);
+		void SetSource(const std::string& source);
+		void SetHistogramSpec(const std::string& fullpath);
+		void SetCutRaster(int cells);
+		void SetMultiOutputs(const std::string& list);
+		void SetTrigger(const std::string& partname);
+		void SetTriggerLookback(double lookback);
 		bool SetKinematicParameters(int zt, int at, int zp, int ap, int ze, int ae, double b, double theta, double bke);
 	
 		inline int GetRunMin() const { return m_rmin; }
@@ -66,6 +84,21 @@ namespace EventBuilder {
 		inline std::string GetCutList() const { return m_cutList; }
 		inline std::string GetScalerFile() const { return m_scalerfile; }
 		inline std::string GetCebraGainFile() const { return m_cebragainfile; }
+		inline std::string GetReadMode() const { return m_readMode; }
+		inline std::string GetArchiveMode() const { return m_archiveMode; }
+		inline int GetBufferBudget() const { return m_bufferBudget; }
+		inline int GetThreads() const { return m_threads; }
+		inline int GetJobs() const { return m_jobs; }
+		inline std::string GetPipeline() const { return m_pipeline; }
+		inline std::string GetMergeMode() const { return m_mergeMode; }
+		inline int GetReorderDepth() const { return m_reorderDepth; }
+		inline int GetExternalSort() const { return m_externalSort; }
+		inline std::string GetSource() const { return m_source; }
+		inline std::string GetHistogramSpec() const { return m_histogramSpec; }
+		inline int GetCutRaster() const { return m_cutRaster; }
+		inline std::string GetTrigger() const { return m_trigger; }
+		inline double GetTriggerLookback() const { return m_triggerLookback; }
+		inline std::string GetMultiOutputs() const { return m_multiOutputs; }
 		void DefaultProgressCallback(long curVal, long totalVal);
 		inline void SetProgressCallbackFunc(const ProgressCallbackFunc& function) { m_progressCallback = function; }
 		inline void SetProgressFraction(double frac) { m_progressFraction = frac; }
@@ -77,11 +110,19 @@ namespace EventBuilder {
 			ConvertSlowA,
 			ConvertFast,
 			ConvertFastA,
+			ConvertMulti,
 			Merge,
 			Plot
 		};
 	
 	private:
+		using RunConversion = std::function<void(CompassRun& converter, const std::string& outfile)>;
+
+		int ConvertRuns(const std::string& outprefix, const RunConversion& convert, bool rawInput = false);
+		bool SearchRunInputs();
+		void ConfigureRun(CompassRun& converter);
+		void UnpackRun(CompassRun& converter, const std::string& binfile, const std::string& unpack_dir, bool rawInput);
+		void CleanupRun(const std::string& unpack_dir, bool rawInput);
 	
 		int m_rmin, m_rmax;
 		int m_ZT, m_AT, m_ZP, m_AP, m_ZE, m_AE, m_ZR, m_AR;
@@ -93,6 +134,22 @@ namespace EventBuilder {
 		std::string m_cutList;
 		std::string m_scalerfile;
                 std::string m_cebragainfile;
+		std::string m_readMode; //CompassFile read mode, Buffered, MemoryMapped, or Prefetch
+		std::string m_archiveMode; //Extract archives with tar, or Stream them in process
+		int m_bufferBudget; //MB shared by the CompassFile buffers of a run; 0 for the fixed per file size
+		int m_threads; //threads per run; more than one builds the run in parallel time slices
+		int m_jobs; //runs converted at the same time
+		std::string m_pipeline; //On runs the stages of each conversion on their own threads, Off runs them in turn
+		std::string m_mergeMode; //time ordering of the hits of a run, Heap (hit by hit) or Block (radix sorted blocks)
+		int m_reorderDepth; //hits a hit may be out of time order within its file and still be put back; 0 for no reordering
+		int m_externalSort; //MB of memory for sorting runs out of core; 0 to merge the binaries directly
+		std::string m_source; //input of the event building conversions, Binary (the archives) or RawRoot (the raw_root files)
+		std::string m_histogramSpec; //file defining the histograms of Plot, or None for the built in set
+		int m_cutRaster; //cells per axis of the masks of the cuts; 0 tests every event against the cut polygons
+		static constexpr int s_maxCutRaster = 4096;
+		std::string m_multiOutputs; //comma separated conversions whose outputs ConvertMulti writes in one pass
+		std::string m_trigger; //focal plane part (channel map name) that opens slow events, or None for any hit
+		double m_triggerLookback; //ps before the trigger included in its event
 	
 		double m_SlowWindow;
 		double m_FastWindowIonCh;
@@ -0,0 +1,171 @@
+/*
+	EventVariables.cpp
+	Access to the fields of a ProcessedEvent by name, for the cuts and histograms defined in files. A name is
+	resolved once, to the byte offset of the field within the structure; reading the field of an event is then a
+	single load at that offset, with no lookup and no copy of the event. Every double field of the ProcessedEvent
+	can be named, i.e. xavg, anodeBack, cebraE0, delayFrontLeftTime.
+
+	EventExpression builds on this: a sum of fields, each optionally scaled, and constants
+	(i.e. delayFrontLeftTime-anodeFrontTime or 0.5*delayBackRightE+0.5*delayBackLeftE), compiled once.
+*/
+#include "EventBuilder.h"
+#include "EventVariables.h"
+#include <cctype>
+#include <cstdlib>
+
+namespace EventBuilder {
+
+	using EventField = double ProcessedEvent::*;
+
+	/*
+		ADD MORE VARIABLES HERE! (any new double field of the ProcessedEvent)
+	*/
+	static std::unordered_map<std::string, std::size_t> MakeVariableTable()
+	{
+		static const ProcessedEvent reference;
+		std::unordered_map<std::string, std::size_t> table;
+		auto add = [&](const std::string& name, EventField field)
+		{
+			table[name] = reinterpret_cast<const char*>(&(reference.*field)) - reinterpret_cast<const char*>(&reference);
+		};
+
+		add("fp1_tdiff", &ProcessedEvent::fp1_tdiff);
+		add("fp2_tdiff", &ProcessedEvent::fp2_tdiff);
+		add("fp1_tsum", &ProcessedEvent::fp1_tsum);
+		add("fp2_tsum", &ProcessedEvent::fp2_tsum);
+		add("fp1_tcheck", &ProcessedEvent::fp1_tcheck);
+		add("fp2_tcheck", &ProcessedEvent::fp2_tcheck);
+		add("fp1_y", &ProcessedEvent::fp1_y);
+		add("fp2_y", &ProcessedEvent::fp2_y);
+		add("anodeFront", &ProcessedEvent::anodeFront);
+		add("anodeBack", &ProcessedEvent::anodeBack);
+		add("scintRight", &ProcessedEvent::scintRight);
+		add("scintLeft", &ProcessedEvent::scintLeft);
+		add("scintRightShort", &ProcessedEvent::scintRightShort);
+		add("scintLeftShort", &ProcessedEvent::scintLeftShort);
+		add("cathode", &ProcessedEvent::cathode);
+		add("xavg", &ProcessedEvent::xavg);
+		add("x1", &ProcessedEvent::x1);
+		add("x2", &ProcessedEvent::x2);
+		add("theta", &ProcessedEvent::theta);
+		add("delayFrontRightE", &ProcessedEvent::delayFrontRightE);
+		add("delayFrontLeftE", &ProcessedEvent::delayFrontLeftE);
+		add("delayBackRightE", &ProcessedEvent::delayBackRightE);
+		add("delayBackLeftE", &ProcessedEvent::delayBackLeftE);
+		add("delayFrontRightShort", &ProcessedEvent::delayFrontRightShort);
+		add("delayFrontLeftShort", &ProcessedEvent::delayFrontLeftShort);
+		add("delayBackRightShort", &ProcessedEvent::delayBackRightShort);
+		add("delayBackLeftShort", &ProcessedEvent::delayBackLeftShort);
+		add("anodeFrontTime", &ProcessedEvent::anodeFrontTime);
+		add("anodeBackTime", &ProcessedEvent::anodeBackTime);
+		add("scintRightTime", &ProcessedEvent::scintRightTime);
+		add("scintLeftTime", &ProcessedEvent::scintLeftTime);
+		add("delayFrontMaxTime", &ProcessedEvent::delayFrontMaxTime);
+		add("delayBackMaxTime", &ProcessedEvent::delayBackMaxTime);
+		add("delayFrontLeftTime", &ProcessedEvent::delayFrontLeftTime);
+		add("delayFrontRightTime", &ProcessedEvent::delayFrontRightTime);
+		add("delayBackLeftTime", &ProcessedEvent::delayBackLeftTime);
+		add("delayBackRightTime", &ProcessedEvent::delayBackRightTime);
+		add("cathodeTime", &ProcessedEvent::cathodeTime);
+		add("monitorE", &ProcessedEvent::monitorE);
+		add("monitorShort", &ProcessedEvent::monitorShort);
+		add("monitorTime", &ProcessedEvent::monitorTime);
+		add("cebraE0", &ProcessedEvent::cebraE0);
+		add("cebraE1", &ProcessedEvent::cebraE1);
+		add("cebraE2", &ProcessedEvent::cebraE2);
+		add("cebraE3", &ProcessedEvent::cebraE3);
+		add("cebraE4", &ProcessedEvent::cebraE4);
+		add("cebraChannel0", &ProcessedEvent::cebraChannel0);
+		add("cebraChannel1", &ProcessedEvent::cebraChannel1);
+		add("cebraChannel2", &ProcessedEvent::cebraChannel2);
+		add("cebraChannel3", &ProcessedEvent::cebraChannel3);
+		add("cebraChannel4", &ProcessedEvent::cebraChannel4);
+		add("cebraTime0", &ProcessedEvent::cebraTime0);
+		add("cebraTime1", &ProcessedEvent::cebraTime1);
+		add("cebraTime2", &ProcessedEvent::cebraTime2);
+		add("cebraTime3", &ProcessedEvent::cebraTime3);
+		add("cebraTime4", &ProcessedEvent::cebraTime4);
+		return table;
+	}
+
+	bool GetEventVariableOffset(const std::string& name, std::size_t& offset)
+	{
+		static const std::unordered_map<std::string, std::size_t> table = MakeVariableTable();
+		auto entry = table.find(name);
+		if(entry == table.end())
+			return false;
+		offset = entry->second;
+		return true;
+	}
+
+	EventExpression::EventExpression() :
+		m_text(""), m_constant(0.0)
+	{
+	}
+
+	/*
+		Terms are separated by + or -, and each is a number, a variable name, or number*name. No spaces. On failure the
+		expression is left empty (always 0) and false returned.
+	*/
+	bool EventExpression::Compile(const std::string& text)
+	{
+		m_text = text;
+		m_constant = 0.0;
+		m_terms.clear();
+
+		std::size_t pos = 0;
+		while(pos < text.size())
+		{
+			double sign = 1.0;
+			if(text[pos] == '+' || text[pos] == '-')
+			{
+				sign = text[pos] == '-' ? -1.0 : 1.0;
+				pos++;
+			}
+			else if(pos != 0)
+				break;
+
+			double coefficient = 1.0;
+			if(pos < text.size() && (std::isdigit(text[pos]) || text[pos] == '.'))
+			{
+				char* end;
+				coefficient = std::strtod(text.c_str() + pos, &end);
+				if(end == text.c_str() + pos) //i.e. a lone '.'; malformed
+					break;
+				pos = end - text.c_str();
+				if(pos >= text.size() || text[pos] != '*')
+				{
+					m_constant += sign*coefficient;
+					continue;
+				}
+				pos++; //the '*'
+			}
+
+			std::size_t start = pos;
+			while(pos < text.size() && (std::isalnum(text[pos]) || text[pos] == '_'))
+				pos++;
+			std::string name = text.substr(start, pos - start);
+			std::size_t offset;
+			if(name.empty())
+				break;
+			else if(!GetEventVariableOffset(name, offset))
+			{
+				EVB_WARN("Unknown variable {0} in expression {1} at EventExpression::Compile()!", name, text);
+				m_constant = 0.0;
+				m_terms.clear();
+				return false;
+			}
+			m_terms.push_back({ offset, sign*coefficient });
+		}
+
+		if(pos < text.size() || text.empty() || (pos > 0 && (text.back() == '+' || text.back() == '-' || text.back() == '*')))
+		{
+			EVB_WARN("Malformed expression {0} at EventExpression::Compile()!", text);
+			m_constant = 0.0;
+			m_terms.clear();
+			return false;
+		}
+		return true;
+	}
+
+}
@@ -0,0 +1,54 @@
+/*
+	EventVariables.h
+	Access to the fields of a ProcessedEvent by name, for the cuts and histograms defined in files. A name is
+	resolved once, to the byte offset of the field within the structure; reading the field of an event is then a
+	single load at that offset, with no lookup and no copy of the event. Every double field of the ProcessedEvent
+	can be named, i.e. xavg, anodeBack, cebraE0, delayFrontLeftTime.
+
+	EventExpression builds on this: a sum of fields, each optionally scaled, and constants
+	(i.e. delayFrontLeftTime-anodeFrontTime or 0.5*delayBackRightE+0.5*delayBackLeftE), compiled once.
+*/
+#ifndef EVENTVARIABLES_H
+#define EVENTVARIABLES_H
+
+#include "DataStructs.h"
+
+namespace EventBuilder {
+
+	bool GetEventVariableOffset(const std::string& name, std::size_t& offset);
+
+	inline double ReadEventVariable(const ProcessedEvent& event, std::size_t offset)
+	{
+		return *reinterpret_cast<const double*>(reinterpret_cast<const char*>(&event) + offset);
+	}
+
+	class EventExpression
+	{
+	public:
+		EventExpression();
+		bool Compile(const std::string& text);
+		inline const std::string& GetText() const { return m_text; }
+
+		inline double Evaluate(const ProcessedEvent& event) const
+		{
+			double value = m_constant;
+			for(auto& term : m_terms)
+				value += term.coefficient*ReadEventVariable(event, term.offset);
+			return value;
+		}
+
+	private:
+		struct Term
+		{
+			std::size_t offset;
+			double coefficient;
+		};
+
+		std::string m_text;
+		double m_constant;
+		std::vector<Term> m_terms;
+	};
+
+}
+
+#endif
@@ -0,0 +1,122 @@
+/*
+	ExternalSorter.cpp
+	Out of core time ordering, for runs whose binaries are not time ordered (i.e. after a board reset), which the
+	merge alone can't put right. The hits of the run are read in chunks that fit a memory cap, and each chunk is
+	sorted (HitSorter) and spilled to disk as a CoMPASS binary, with the timestamps already shifted. Every chunk
+	is then time ordered, so the chunks can be opened as CompassFiles and merged by the HitMerger as usual.
+	The chunk files are removed when the ExternalSorter goes away.
+*/
+#include "EventBuilder.h"
+#include "ExternalSorter.h"
+#include "HitMerger.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+
+namespace EventBuilder {
+
+	ExternalSorter::ExternalSorter(const std::string& directory, uint64_t memory) :
+		m_directory(directory), m_memory(memory)
+	{
+	}
+
+	ExternalSorter::~ExternalSorter()
+	{
+		RemoveChunks();
+	}
+
+	/*
+		Read every hit of files (merged, though the files are out of order, so the stream is only roughly in time) and
+		write it out in sorted chunks of as many hits as fit the memory cap. Returns false if a chunk can't be written.
+	*/
+	bool ExternalSorter::Spill(std::vector<CompassFile>& files)
+	{
+		RemoveChunks();
+		uint64_t maxHits = std::numeric_limits<uint32_t>::max(); //HitSorter limit
+		std::size_t chunkHits = std::max<uint64_t>(std::min(m_memory/s_bytesPerHit, maxHits), s_writeHits);
+
+		HitMerger merger;
+		merger.Init(files);
+		m_chunk.clear();
+		m_chunk.reserve(chunkHits);
+		while(merger.GetNextHits(m_chunk, chunkHits - m_chunk.size()) > 0)
+		{
+			if(m_chunk.size() == chunkHits && !WriteChunk())
+				return false;
+		}
+		if(!m_chunk.empty() && !WriteChunk())
+			return false;
+
+		m_chunk = HitBatch(); //release the memory for the build
+		m_sorted = HitBatch();
+		return true;
+	}
+
+	/*Sort the hits of m_chunk and write them to the next chunk file, leaving m_chunk empty*/
+	bool ExternalSorter::WriteChunk()
+	{
+		std::string name = m_directory + "sort_chunk_" + std::to_string(m_chunks.size()) + ".tmp";
+		std::ofstream output(name, std::ios::binary | std::ios::trunc);
+		if(!output.is_open())
+		{
+			EVB_ERROR("Unable to open sort chunk {0} at ExternalSorter::WriteChunk()!", name);
+			return false;
+		}
+		m_chunks.push_back(name);
+
+		m_sorter.Sort(m_chunk, m_sorted);
+		m_chunk.clear();
+
+		output.write((const char*) &s_header, sizeof(s_header));
+		std::vector<char> records(s_writeHits*s_recordSize);
+		for(std::size_t first=0; first<m_sorted.size(); first+=s_writeHits)
+		{
+			std::size_t nhits = std::min(s_writeHits, m_sorted.size() - first);
+			char* record = records.data();
+			for(std::size_t i=first; i<first+nhits; i++)
+			{
+				std::memcpy(record, &m_sorted.board[i], 2);
+				std::memcpy(record + 2, &m_sorted.channel[i], 2);
+				std::memcpy(record + 4, &m_sorted.timestamp[i], 8);
+				std::memcpy(record + 12, &m_sorted.energy[i], 2);
+				std::memcpy(record + 14, &m_sorted.energyShort[i], 2);
+				std::memcpy(record + 16, &m_sorted.flags[i], 4);
+				record += s_recordSize;
+			}
+			output.write(records.data(), nhits*s_recordSize);
+		}
+
+		if(!output)
+		{
+			EVB_ERROR("Unable to write sort chunk {0} at ExternalSorter::WriteChunk(); is the disk full?", name);
+			return false;
+		}
+		return true;
+	}
+
+	/*
+		Open the chunks for merging. The chunks hold shifted timestamps, so no ChannelTable is attached. The memory
+		cap is shared out as the read buffers of the chunks.
+	*/
+	std::vector<CompassFile> ExternalSorter::OpenChunks() const
+	{
+		std::vector<CompassFile> chunks;
+		chunks.reserve(m_chunks.size());
+		int bufferHits = std::max<uint64_t>(std::min<uint64_t>(m_memory/(s_recordSize*std::max<std::size_t>(m_chunks.size(), 1)), std::numeric_limits<int>::max()/s_recordSize), s_minBufferHits);
+		for(auto& name : m_chunks)
+		{
+			chunks.emplace_back(name, CompassFile::ReadMode::Buffered);
+			chunks.back().SetBufferSize(bufferHits);
+		}
+		return chunks;
+	}
+
+	void ExternalSorter::RemoveChunks()
+	{
+		for(auto& name : m_chunks)
+			std::remove(name.c_str());
+		m_chunks.clear();
+	}
+
+}
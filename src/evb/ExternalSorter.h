@@ -0,0 +1,46 @@
+/*
+	ExternalSorter.h
+	Out of core time ordering, for runs whose binaries are not time ordered (i.e. after a board reset), which the
+	merge alone can't put right. The hits of the run are read in chunks that fit a memory cap, and each chunk is
+	sorted (HitSorter) and spilled to disk as a CoMPASS binary, with the timestamps already shifted. Every chunk
+	is then time ordered, so the chunks can be opened as CompassFiles and merged by the HitMerger as usual.
+	The chunk files are removed when the ExternalSorter goes away.
+*/
+#ifndef EXTERNALSORTER_H
+#define EXTERNALSORTER_H
+
+#include "CompassFile.h"
+#include "HitSorter.h"
+
+namespace EventBuilder {
+
+	class ExternalSorter
+	{
+	public:
+		ExternalSorter(const std::string& directory, uint64_t memory);
+		~ExternalSorter();
+		bool Spill(std::vector<CompassFile>& files);
+		std::vector<CompassFile> OpenChunks() const;
+		void RemoveChunks();
+		inline std::size_t GetNumberOfChunks() const { return m_chunks.size(); }
+
+	private:
+		bool WriteChunk();
+
+		std::string m_directory; //where the chunks are written
+		uint64_t m_memory; //bytes
+		std::vector<std::string> m_chunks;
+		HitBatch m_chunk;
+		HitBatch m_sorted;
+		HitSorter m_sorter;
+
+		static constexpr uint64_t s_bytesPerHit = 70; //chunk, sorted copy and sort scratch
+		static constexpr uint16_t s_header = 0x0005; //CoMPASS header: Energy and EnergyShort
+		static constexpr std::size_t s_recordSize = 20; //board, channel, timestamp, energy, energyShort, flags
+		static constexpr std::size_t s_writeHits = 65536; //records per write
+		static constexpr int s_minBufferHits = 1024;
+	};
+
+}
+
+#endif
@@ -1,12 +1,20 @@
 #include "EventBuilder.h"
 #include "FastSort.h"
+#include "CompassHit.h"
 
 namespace EventBuilder {
-	//windows given in picoseconds, converted to nanoseconds
+
+	//Absolute time between two hits, in integer ps
+	static inline uint64_t TimeDifference(const DetectorHit& a, const DetectorHit& b)
+	{
+		return a.Timestamp > b.Timestamp ? a.Timestamp - b.Timestamp : b.Timestamp - a.Timestamp;
+	}
+
+	//windows given in picoseconds, compared to the integer timestamps
 	//FastSort::FastSort(float si_windowSize, float ion_windowSize) :
 	//	si_coincWindow(si_windowSize/1.0e3), ion_coincWindow(ion_windowSize/1.0e3), event_address(nullptr)
 	FastSort::FastSort(float cebr_windowSize, float ion_windowSize) :
-		cebr_coincWindow(cebr_windowSize/1.0e3), ion_coincWindow(ion_windowSize/1.0e3), event_address(nullptr)
+		cebr_coincWindow(ToPicoseconds(cebr_windowSize)), ion_coincWindow(ToPicoseconds(ion_windowSize)), event_address(nullptr), slowEvent(nullptr), fastEvent(nullptr)
 	{
 	}
 	
@@ -15,21 +23,22 @@ namespace EventBuilder {
 		delete event_address;
 	}
 	
+	/*Resets clear the vectors of the caller's buffer in place, so that the memory they hold is reused for the next fast event*/
 	void FastSort::ResetCEBRA() 
 	{
 		for(int i=0; i<5; i++)
-			fastEvent.cebraArray[i] = cebrblank;
+			ClearHits(fastEvent->cebraArray[i]);
 	}
 
 /*	void FastSort::ResetSABRE() 
 	{
 		for(int i=0; i<5; i++)
-			fastEvent.sabreArray[i] = sblank;
+			fastEvent->sabreArray[i] = sblank;
 	}
 */	
 	void FastSort::ResetFocalPlane() 
 	{
-		fastEvent.focalPlane = fpblank;
+		ClearHits(fastEvent->focalPlane);
 	}
 	
 	/*Assign a set of ion chamber data to the scintillator*/
@@ -39,35 +48,35 @@ namespace EventBuilder {
 	   *In this case, I chose one of the anodes. But in principle you could also choose any other part of the ion
 	   *chamber
 	   */
-		if(slowEvent.focalPlane.anodeB.size() > ionch_index) 
+		if(slowEvent->focalPlane.anodeB.size() > ionch_index) 
 		{ //Back anode required to move on`
 	
-			float anodeRelTime = fabs(slowEvent.focalPlane.anodeB[ionch_index].Time - slowEvent.focalPlane.scintL[scint_index].Time);
+			uint64_t anodeRelTime = TimeDifference(slowEvent->focalPlane.anodeB[ionch_index], slowEvent->focalPlane.scintL[scint_index]);
 			if(anodeRelTime > ion_coincWindow) 
 				return; //Window check
 	
-			fastEvent.focalPlane.anodeB.push_back(slowEvent.focalPlane.anodeB[ionch_index]);
-			fastEvent.focalPlane.scintL.push_back(slowEvent.focalPlane.scintL[scint_index]);
-			if(slowEvent.focalPlane.delayFL.size() > ionch_index)
-				fastEvent.focalPlane.delayFL.push_back(slowEvent.focalPlane.delayFL[ionch_index]);
+			fastEvent->focalPlane.anodeB.push_back(slowEvent->focalPlane.anodeB[ionch_index]);
+			fastEvent->focalPlane.scintL.push_back(slowEvent->focalPlane.scintL[scint_index]);
+			if(slowEvent->focalPlane.delayFL.size() > ionch_index)
+				fastEvent->focalPlane.delayFL.push_back(slowEvent->focalPlane.delayFL[ionch_index]);
 	
-			if(slowEvent.focalPlane.delayFR.size() > ionch_index)
-				fastEvent.focalPlane.delayFR.push_back(slowEvent.focalPlane.delayFR[ionch_index]);
+			if(slowEvent->focalPlane.delayFR.size() > ionch_index)
+				fastEvent->focalPlane.delayFR.push_back(slowEvent->focalPlane.delayFR[ionch_index]);
 	
-			if(slowEvent.focalPlane.delayBR.size() > ionch_index)
-				fastEvent.focalPlane.delayBR.push_back(slowEvent.focalPlane.delayBR[ionch_index]);
+			if(slowEvent->focalPlane.delayBR.size() > ionch_index)
+				fastEvent->focalPlane.delayBR.push_back(slowEvent->focalPlane.delayBR[ionch_index]);
 	
-			if(slowEvent.focalPlane.delayBL.size() > ionch_index)
-				fastEvent.focalPlane.delayBL.push_back(slowEvent.focalPlane.delayBL[ionch_index]);
+			if(slowEvent->focalPlane.delayBL.size() > ionch_index)
+				fastEvent->focalPlane.delayBL.push_back(slowEvent->focalPlane.delayBL[ionch_index]);
 	
-			if(slowEvent.focalPlane.scintR.size() > ionch_index)
-				fastEvent.focalPlane.scintR.push_back(slowEvent.focalPlane.scintR[ionch_index]);
+			if(slowEvent->focalPlane.scintR.size() > ionch_index)
+				fastEvent->focalPlane.scintR.push_back(slowEvent->focalPlane.scintR[ionch_index]);
 	
-			if(slowEvent.focalPlane.anodeF.size() > ionch_index)
-				fastEvent.focalPlane.anodeF.push_back(slowEvent.focalPlane.anodeF[ionch_index]);
+			if(slowEvent->focalPlane.anodeF.size() > ionch_index)
+				fastEvent->focalPlane.anodeF.push_back(slowEvent->focalPlane.anodeF[ionch_index]);
 	
-			if(slowEvent.focalPlane.cathode.size() > ionch_index)
-				fastEvent.focalPlane.cathode.push_back(slowEvent.focalPlane.cathode[ionch_index]);
+			if(slowEvent->focalPlane.cathode.size() > ionch_index)
+				fastEvent->focalPlane.cathode.push_back(slowEvent->focalPlane.cathode[ionch_index]);
 		}
 	}
 	
@@ -80,25 +89,25 @@ namespace EventBuilder {
 			std::vector<DetectorHit> rings;
 			std::vector<DetectorHit> wedges;
 	
-			if(slowEvent.sabreArray[i].rings.size() == 0 || slowEvent.sabreArray[i].wedges.size() == 0) 
+			if(slowEvent->sabreArray[i].rings.size() == 0 || slowEvent->sabreArray[i].wedges.size() == 0) 
 				continue; //save some time on empties
 	
 			//Dump sabre data that doesnt fall within the fast coincidence window with the scint
-			for(unsigned int j=0; j<slowEvent.sabreArray[i].rings.size(); j++) 
+			for(unsigned int j=0; j<slowEvent->sabreArray[i].rings.size(); j++) 
 			{
-				float sabreRelTime = fabs(slowEvent.sabreArray[i].rings[j].Time - slowEvent.focalPlane.scintL[scint_index].Time);
+				float sabreRelTime = fabs(slowEvent->sabreArray[i].rings[j].Time - slowEvent->focalPlane.scintL[scint_index].Time);
 				if(sabreRelTime < si_coincWindow)
-					rings.push_back(slowEvent.sabreArray[i].rings[j]);
+					rings.push_back(slowEvent->sabreArray[i].rings[j]);
 			}
-			for(unsigned int j=0; j<slowEvent.sabreArray[i].wedges.size(); j++) 
+			for(unsigned int j=0; j<slowEvent->sabreArray[i].wedges.size(); j++) 
 			{
-				float sabreRelTime = fabs(slowEvent.sabreArray[i].wedges[j].Time - slowEvent.focalPlane.scintL[scint_index].Time);
+				float sabreRelTime = fabs(slowEvent->sabreArray[i].wedges[j].Time - slowEvent->focalPlane.scintL[scint_index].Time);
 				if(sabreRelTime < si_coincWindow) 
-					wedges.push_back(slowEvent.sabreArray[i].wedges[j]);
+					wedges.push_back(slowEvent->sabreArray[i].wedges[j]);
 			}
 		
-			fastEvent.sabreArray[i].rings = rings;
-			fastEvent.sabreArray[i].wedges = wedges;
+			fastEvent->sabreArray[i].rings = rings;
+			fastEvent->sabreArray[i].wedges = wedges;
 		}
 	}
 	*/
@@ -106,52 +115,42 @@ namespace EventBuilder {
 	/*Assign a set of CEBRA data that falls within the coincidence window*/
 	void FastSort::ProcessCEBRA(unsigned int scint_index) {
 	for(int i=0; i<5; i++) { //loop over CEBRA detectors
-		std::vector<DetectorHit> cebr;
+		std::vector<DetectorHit>& cebr = fastEvent->cebraArray[i].cebr; //cleared by ResetCEBRA()
 
-		if(slowEvent.cebraArray[i].cebr.size() == 0) continue; //save some time on empties
+		if(slowEvent->cebraArray[i].cebr.size() == 0) continue; //save some time on empties
 
 		/*Dump cebra data that doesnt fall within the fast coincidence window with the scint*/
-		for(unsigned int j=0; j<slowEvent.cebraArray[i].cebr.size(); j++) {
-		float cebraRelTime = fabs(slowEvent.cebraArray[i].cebr[j].Time - slowEvent.focalPlane.scintL[scint_index].Time);
+		for(unsigned int j=0; j<slowEvent->cebraArray[i].cebr.size(); j++) {
+		uint64_t cebraRelTime = TimeDifference(slowEvent->cebraArray[i].cebr[j], slowEvent->focalPlane.scintL[scint_index]);
 		if(cebraRelTime < cebr_coincWindow) {
-			cebr.push_back(slowEvent.cebraArray[i].cebr[j]);
+			cebr.push_back(slowEvent->cebraArray[i].cebr[j]);
 		}
 		}
-		fastEvent.cebraArray[i].cebr = cebr;
 	}
 	}
 	std::vector<CoincEvent> FastSort::GetFastEvents(CoincEvent& event) 
 	{
-		slowEvent = event;
 		std::vector<CoincEvent> fast_events;
+		CoincEvent buffer;
+		GetFastEvents(event, buffer, [&fast_events](CoincEvent& fast_event) { fast_events.push_back(fast_event); });
+		return fast_events;
+	}
+
+	/*Point at the slow event and the output buffer, and find the number of ion chamber hits to pair with each scint*/
+	unsigned int FastSort::StartEvent(const CoincEvent& event, CoincEvent& fast_event) 
+	{
+		slowEvent = &event;
+		fastEvent = &fast_event;
 	
 		unsigned int sizeArray[7];
-		sizeArray[0] = slowEvent.focalPlane.delayFL.size();
-		sizeArray[1] = slowEvent.focalPlane.delayFR.size();
-		sizeArray[2] = slowEvent.focalPlane.delayBL.size();
-		sizeArray[3] = slowEvent.focalPlane.delayBR.size();
-		sizeArray[4] = slowEvent.focalPlane.anodeF.size();
-		sizeArray[5] = slowEvent.focalPlane.anodeB.size();
-		sizeArray[6] = slowEvent.focalPlane.cathode.size();
-		unsigned int maxSize = *std::max_element(sizeArray, sizeArray+7);
-		//loop over scints
-		for(unsigned int i=0; i<slowEvent.focalPlane.scintL.size(); i++) 
-		{
-		//	ResetSABRE();
-		//	ProcessSABRE(i);
-			ResetCEBRA();
-			ProcessCEBRA(i);
-			//loop over ion chamber
-			//NOTE: as written, this dumps data that does not have an ion chamber hit!
-			//If you want scint/SABRE singles, move the fill outside of this loop
-			for(unsigned int j=0; j<maxSize; j++) 
-			{
-				ResetFocalPlane();
-				ProcessFocalPlane(i, j);
-				fast_events.push_back(fastEvent);
-			}
-		}
-		return fast_events;
+		sizeArray[0] = slowEvent->focalPlane.delayFL.size();
+		sizeArray[1] = slowEvent->focalPlane.delayFR.size();
+		sizeArray[2] = slowEvent->focalPlane.delayBL.size();
+		sizeArray[3] = slowEvent->focalPlane.delayBR.size();
+		sizeArray[4] = slowEvent->focalPlane.anodeF.size();
+		sizeArray[5] = slowEvent->focalPlane.anodeB.size();
+		sizeArray[6] = slowEvent->focalPlane.cathode.size();
+		return *std::max_element(sizeArray, sizeArray+7);
 	}
 
 }
\ No newline at end of file
@@ -19,8 +19,35 @@ namespace EventBuilder {
 		FastSort(float cebr_windowSize, float ion_windowSize);
 		~FastSort();
 		std::vector<CoincEvent> GetFastEvents(CoincEvent& event);
+
+		/*
+			Zero copy version: each fast event is built directly in fast_event (i.e. the caller's branch variable), reading
+			the slow event in place, and callback(fast_event) is called once it is complete. fast_event is overwritten by
+			the next fast event. A template, so that the callback is inlined rather than wrapped in a std::function.
+		*/
+		template<typename Callback>
+		void GetFastEvents(const CoincEvent& event, CoincEvent& fast_event, Callback&& callback)
+		{
+			unsigned int maxSize = StartEvent(event, fast_event);
+			//loop over scints
+			for(unsigned int i=0; i<slowEvent->focalPlane.scintL.size(); i++) 
+			{
+				ResetCEBRA();
+				ProcessCEBRA(i);
+				//loop over ion chamber
+				//NOTE: as written, this dumps data that does not have an ion chamber hit!
+				//If you want scint/SABRE singles, move the fill outside of this loop
+				for(unsigned int j=0; j<maxSize; j++) 
+				{
+					ResetFocalPlane();
+					ProcessFocalPlane(i, j);
+					callback(*fastEvent);
+				}
+			}
+		}
 	
 	private:
+		unsigned int StartEvent(const CoincEvent& event, CoincEvent& fast_event);
 		void ResetCEBRA();
 	//	void ResetSABRE();
 		void ResetFocalPlane();
@@ -29,12 +56,10 @@ namespace EventBuilder {
 		void ProcessFocalPlane(unsigned int scint_index, unsigned int ionch_index);
 	
 	//	float si_coincWindow, ion_coincWindow;
-		float cebr_coincWindow, ion_coincWindow;
-		CoincEvent *event_address, slowEvent;
-		CoincEvent fastEvent, blank;
-		CeBrADetector cebrblank;
-	//	SabreDetector sblank;
-		FPDetector fpblank;
+		uint64_t cebr_coincWindow, ion_coincWindow; //ps
+		CoincEvent *event_address;
+		const CoincEvent* slowEvent; //event being fast sorted; NOT owned by FastSort
+		CoincEvent* fastEvent; //caller's buffer for the current fast event; NOT owned by FastSort
 	
 	};
 
@@ -8,22 +8,59 @@ namespace EventBuilder {
 	{
 	}
 	
-	FlagHandler::FlagHandler(const std::string& filename) :
-		log(filename)
+	FlagHandler::FlagHandler(const std::string& filename)
 	{
+		if(!filename.empty())
+			log.open(filename);
 	}
 	
 	FlagHandler::~FlagHandler() 
 	{
+		if(!log.is_open())
+			return;
 		WriteLog();
 		log.close();
 	}
+
+	FlagCount& FlagCount::operator+=(const FlagCount& rhs)
+	{
+		total_counts += rhs.total_counts;
+		dead_time += rhs.dead_time;
+		time_roll += rhs.time_roll;
+		time_reset += rhs.time_reset;
+		fake_event += rhs.fake_event;
+		mem_full += rhs.mem_full;
+		trig_lost += rhs.trig_lost;
+		n_trig_lost += rhs.n_trig_lost;
+		sat_in_gate += rhs.sat_in_gate;
+		trig_1024 += rhs.trig_1024;
+		sat_input += rhs.sat_input;
+		n_trig_count += rhs.n_trig_count;
+		event_not_matched += rhs.event_not_matched;
+		fine_time += rhs.fine_time;
+		pile_up += rhs.pile_up;
+		pll_lock_loss += rhs.pll_lock_loss;
+		over_temp += rhs.over_temp;
+		adc_shutdown += rhs.adc_shutdown;
+		return *this;
+	}
+
+	void FlagHandler::Merge(const FlagHandler& other)
+	{
+		std::lock_guard<std::mutex> guard(merge_mutex);
+		if(other.event_counts.size() > event_counts.size())
+			event_counts.resize(other.event_counts.size());
+		for(std::size_t gchan=0; gchan<other.event_counts.size(); gchan++)
+			event_counts[gchan] += other.event_counts[gchan];
+	}
 	
 	void FlagHandler::CheckFlag(int board, int channel, int flag) 
 	{
 	
-		int gchan = channel + board*16;
-		FlagCount& counter = event_count_map[gchan]; //yikes
+		std::size_t gchan = channel + board*16;
+		if(gchan >= event_counts.size())
+			event_counts.resize(gchan + 1);
+		FlagCount& counter = event_counts[gchan];
 	
 		counter.total_counts++;
 	
@@ -81,27 +118,30 @@ namespace EventBuilder {
 	{
 		log<<"Event Flag Log"<<std::endl;
 		log<<"-----------------------------"<<std::endl;
-		for(auto& counter : event_count_map) 
+		for(std::size_t gchan=0; gchan<event_counts.size(); gchan++) 
 		{
+			const FlagCount& counter = event_counts[gchan];
+			if(counter.total_counts == 0) //channel never seen
+				continue;
 			log<<"-----------------------------"<<std::endl;
-			log<<"GLOBAL CHANNEL No.: "<<counter.first<<std::endl;
-			log<<"Total number of events: "<<counter.second.total_counts<<std::endl;
-			log<<"Dead time incurred (only for V1724): "<<counter.second.dead_time<<std::endl;
-			log<<"Timestamp rollovers: "<<counter.second.time_roll<<std::endl;
-			log<<"Timestamp resets from external: "<<counter.second.time_reset<<std::endl;
-			log<<"Fake events: "<<counter.second.fake_event<<std::endl;
-			log<<"Memory full: "<<counter.second.mem_full<<std::endl;
-			log<<"Triggers lost: "<<counter.second.trig_lost<<std::endl;
-			log<<"N Triggers lost: "<<counter.second.n_trig_lost<<std::endl;
-			log<<"Saturation within the gate: "<<counter.second.sat_in_gate<<std::endl;
-			log<<"1024 Triggers found: "<<counter.second.trig_1024<<std::endl;
-			log<<"Saturation on input: "<<counter.second.sat_input<<std::endl;
-			log<<"N Triggers counted: "<<counter.second.n_trig_count<<std::endl;
-			log<<"Events not matched: "<<counter.second.event_not_matched<<std::endl;
-			log<<"Pile ups: "<<counter.second.pile_up<<std::endl;
-			log<<"PLL lock lost: "<<counter.second.pll_lock_loss<<std::endl;
-			log<<"Over Temperature: "<<counter.second.over_temp<<std::endl;
-			log<<"ADC Shutdown: "<<counter.second.adc_shutdown<<std::endl;
+			log<<"GLOBAL CHANNEL No.: "<<gchan<<std::endl;
+			log<<"Total number of events: "<<counter.total_counts<<std::endl;
+			log<<"Dead time incurred (only for V1724): "<<counter.dead_time<<std::endl;
+			log<<"Timestamp rollovers: "<<counter.time_roll<<std::endl;
+			log<<"Timestamp resets from external: "<<counter.time_reset<<std::endl;
+			log<<"Fake events: "<<counter.fake_event<<std::endl;
+			log<<"Memory full: "<<counter.mem_full<<std::endl;
+			log<<"Triggers lost: "<<counter.trig_lost<<std::endl;
+			log<<"N Triggers lost: "<<counter.n_trig_lost<<std::endl;
+			log<<"Saturation within the gate: "<<counter.sat_in_gate<<std::endl;
+			log<<"1024 Triggers found: "<<counter.trig_1024<<std::endl;
+			log<<"Saturation on input: "<<counter.sat_input<<std::endl;
+			log<<"N Triggers counted: "<<counter.n_trig_count<<std::endl;
+			log<<"Events not matched: "<<counter.event_not_matched<<std::endl;
+			log<<"Pile ups: "<<counter.pile_up<<std::endl;
+			log<<"PLL lock lost: "<<counter.pll_lock_loss<<std::endl;
+			log<<"Over Temperature: "<<counter.over_temp<<std::endl;
+			log<<"ADC Shutdown: "<<counter.adc_shutdown<<std::endl;
 			log<<"-----------------------------"<<std::endl;
 		}
 	}
@@ -1,7 +1,8 @@
 #ifndef FLAGHANDLER_H
 #define FLAGHANDLER_H
 
-#include <map>
+#include <vector>
+#include <mutex>
 
 namespace EventBuilder {
 
@@ -25,15 +26,18 @@ namespace EventBuilder {
 		long pll_lock_loss=0;
 		long over_temp=0;
 		long adc_shutdown=0;
+
+		FlagCount& operator+=(const FlagCount& rhs);
 	};
 	
 	class FlagHandler 
 	{
 	public:
 		FlagHandler();
-		FlagHandler(const std::string& filename);
+		FlagHandler(const std::string& filename); //empty filename counts without writing a log
 		~FlagHandler();
 		void CheckFlag(int board, int channel, int flag);
+		void Merge(const FlagHandler& other); //add the counts of other; safe to call from several threads
 	
 		const int DeadTime = 0x00000001;
 		const int TimeRollover = 0x00000002;
@@ -55,7 +59,8 @@ namespace EventBuilder {
 	
 	private:
 		std::ofstream log;
-		std::map<int, FlagCount> event_count_map;
+		std::vector<FlagCount> event_counts; //indexed by global channel
+		std::mutex merge_mutex;
 	
 		void WriteLog();
 	};
@@ -0,0 +1,94 @@
+/*
+	HistogramRegistry.cpp
+	Owns a set of histograms which are all booked up front. Booking hands back a typed handle (the index of the
+	histogram), and filling through a handle is an array access, rather than a lookup of the histogram by name on
+	every fill. Handles are only meaningful for the registry which booked them, or for one booked like it (BookLike),
+	which is how each plotting thread gets its own set, filled through the same handles and summed at the end (Add).
+
+	Histograms are kept out of any ROOT directory; Write writes those which were filled to the current directory,
+	so that the output holds the same histograms as when they were made on their first fill.
+*/
+#include "EventBuilder.h"
+#include "HistogramRegistry.h"
+
+namespace EventBuilder {
+
+	HistogramRegistry::HistogramRegistry()
+	{
+	}
+
+	HistogramRegistry::~HistogramRegistry()
+	{
+		Clear();
+	}
+
+	HistogramRegistry::Handle1D HistogramRegistry::Book(const std::string& name, int binsx, double minx, double maxx)
+	{
+		auto entry = m_names.find(name);
+		if(entry != m_names.end() && m_histograms[entry->second]->GetDimension() == 1)
+			return Handle1D{ entry->second };
+		else if(entry != m_names.end())
+			EVB_WARN("Histogram {0} is booked as both 1D and 2D at HistogramRegistry::Book(); both are kept.", name);
+		return Handle1D{ Insert(new TH1F(name.c_str(), name.c_str(), binsx, minx, maxx)) };
+	}
+
+	HistogramRegistry::Handle2D HistogramRegistry::Book(const std::string& name, int binsx, double minx, double maxx, int binsy, double miny, double maxy)
+	{
+		auto entry = m_names.find(name);
+		if(entry != m_names.end() && m_histograms[entry->second]->GetDimension() == 2)
+			return Handle2D{ entry->second };
+		else if(entry != m_names.end())
+			EVB_WARN("Histogram {0} is booked as both 1D and 2D at HistogramRegistry::Book(); both are kept.", name);
+		return Handle2D{ Insert(new TH2F(name.c_str(), name.c_str(), binsx, minx, maxx, binsy, miny, maxy)) };
+	}
+
+	/*Replace the contents of this registry with empty copies of the histograms of other, in the same order*/
+	void HistogramRegistry::BookLike(const HistogramRegistry& other)
+	{
+		Clear();
+		for(auto histogram : other.m_histograms)
+		{
+			TH1* copy = (TH1*) histogram->Clone();
+			copy->Reset();
+			Insert(copy);
+		}
+	}
+
+	/*Sum the histograms of other, which must be booked like this registry, into this one*/
+	void HistogramRegistry::Add(const HistogramRegistry& other)
+	{
+		if(other.m_histograms.size() != m_histograms.size())
+		{
+			EVB_ERROR("Histogram sets of different bookings at HistogramRegistry::Add(); nothing added!");
+			return;
+		}
+		for(std::size_t i=0; i<m_histograms.size(); i++)
+			m_histograms[i]->Add(other.m_histograms[i]);
+	}
+
+	uint32_t HistogramRegistry::Insert(TH1* histogram)
+	{
+		histogram->SetDirectory(nullptr);
+		uint32_t index = m_histograms.size();
+		m_histograms.push_back(histogram);
+		m_names[histogram->GetName()] = index;
+		return index;
+	}
+
+	/*Histograms which were never filled are skipped*/
+	void HistogramRegistry::Write() const
+	{
+		for(auto histogram : m_histograms)
+			if(histogram->GetEntries() > 0)
+				histogram->Write();
+	}
+
+	void HistogramRegistry::Clear()
+	{
+		for(auto histogram : m_histograms)
+			delete histogram;
+		m_histograms.clear();
+		m_names.clear();
+	}
+
+}
@@ -0,0 +1,46 @@
+/*
+	HistogramRegistry.h
+	Owns a set of histograms which are all booked up front. Booking hands back a typed handle (the index of the
+	histogram), and filling through a handle is an array access, rather than a lookup of the histogram by name on
+	every fill. Handles are only meaningful for the registry which booked them, or for one booked like it (BookLike),
+	which is how each plotting thread gets its own set, filled through the same handles and summed at the end (Add).
+
+	Histograms are kept out of any ROOT directory; Write writes those which were filled to the current directory,
+	so that the output holds the same histograms as when they were made on their first fill.
+*/
+#ifndef HISTOGRAMREGISTRY_H
+#define HISTOGRAMREGISTRY_H
+
+namespace EventBuilder {
+
+	class HistogramRegistry
+	{
+	public:
+		struct Handle1D { uint32_t index = 0; };
+		struct Handle2D { uint32_t index = 0; };
+
+		HistogramRegistry();
+		HistogramRegistry(const HistogramRegistry&) = delete;
+		HistogramRegistry& operator=(const HistogramRegistry&) = delete;
+		~HistogramRegistry();
+
+		Handle1D Book(const std::string& name, int binsx, double minx, double maxx);
+		Handle2D Book(const std::string& name, int binsx, double minx, double maxx, int binsy, double miny, double maxy);
+		void BookLike(const HistogramRegistry& other);
+		void Add(const HistogramRegistry& other);
+		inline void Fill(Handle1D handle, double valuex) { m_histograms[handle.index]->Fill(valuex); }
+		inline void Fill(Handle2D handle, double valuex, double valuey) { static_cast<TH2*>(m_histograms[handle.index])->Fill(valuex, valuey); }
+		void Write() const;
+		void Clear();
+		inline std::size_t GetSize() const { return m_histograms.size(); }
+
+	private:
+		uint32_t Insert(TH1* histogram);
+
+		std::vector<TH1*> m_histograms; //owned; indexed by handle
+		std::unordered_map<std::string, uint32_t> m_names; //booking a name twice gives back the same handle
+	};
+
+}
+
+#endif
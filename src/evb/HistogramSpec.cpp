@@ -0,0 +1,172 @@
+/*
+	HistogramSpec.cpp
+	Histograms defined in a file rather than in code, so that the set plotted can be changed (i.e. expensive
+	diagnostics pruned for an experiment) without rebuilding. Each line of the file defines one histogram:
+
+		Name Gate BinsX MinX MaxX VarX [BinsY MinY MaxY VarY]
+
+	where the Var columns are EventExpressions over the ProcessedEvent fields (see EventVariables.h), and Gate is
+	None (every event) or a CutGate over the cut list (i.e. Cut for events inside every cut, protons, or
+	protons&!deuterons). The first line is a header; lines starting with # are comments. The file is read once into
+	a flat fill plan: the expressions and gates compiled and the histograms booked, grouped by gate (ungated
+	first), so filling an event is a walk down the plan testing each gate once against the event's cut mask.
+*/
+#include "EventBuilder.h"
+#include "HistogramSpec.h"
+#include <sstream>
+#include <algorithm>
+#include <unordered_set>
+
+namespace EventBuilder {
+
+	HistogramSpec::HistogramSpec()
+	{
+	}
+
+	/*
+		Gates are compiled against cuts, which must hold the cut list that the plotting will use. Lines which can't be
+		parsed, or whose gate isn't made of cuts in the list, are skipped with a warning. Returns false if no histogram
+		could be read.
+	*/
+	bool HistogramSpec::ReadFile(const std::string& filename, const CutHandler& cuts)
+	{
+		m_entries.clear();
+		m_groups.clear();
+
+		std::ifstream input(filename);
+		if(!input.is_open())
+		{
+			EVB_WARN("Unable to open histogram spec file {0} at HistogramSpec::ReadFile()!", filename);
+			return false;
+		}
+
+		std::string line;
+		std::getline(input, line); //header
+		int lineNumber = 1;
+		std::unordered_set<std::string> names; //histogram names must be unique, as the registry books by name
+		while(std::getline(input, line))
+		{
+			lineNumber++;
+			std::size_t first = line.find_first_not_of(" \t\r");
+			if(first == std::string::npos || line[first] == '#')
+				continue;
+
+			Entry entry;
+			if(!ParseLine(line, entry))
+			{
+				EVB_WARN("Skipping line {0} of histogram spec file {1}: {2}", lineNumber, filename, line);
+				continue;
+			}
+			CutGate gate;
+			if(entry.gate != "None" && !gate.Compile(entry.gate, cuts))
+			{
+				EVB_WARN("Skipping line {0} of histogram spec file {1}: gate {2} isn't a combination of cuts in the cut list", lineNumber, filename, entry.gate);
+				continue;
+			}
+			if(!names.insert(entry.name).second)
+			{
+				EVB_WARN("Skipping line {0} of histogram spec file {1}: a histogram named {2} is already defined", lineNumber, filename, entry.name);
+				continue;
+			}
+			m_entries.push_back(std::move(entry));
+		}
+
+		//Group the entries by gate, in the order the gates first appear, ungated first
+		std::unordered_map<std::string, std::size_t> groupOf;
+		groupOf["None"] = 0;
+		for(const auto& entry : m_entries)
+			groupOf.emplace(entry.gate, groupOf.size());
+		std::stable_sort(m_entries.begin(), m_entries.end(), [&groupOf](const Entry& a, const Entry& b) { return groupOf[a.gate] < groupOf[b.gate]; });
+
+		std::size_t ngated = 0, ngates = 0;
+		for(std::size_t i=0; i<m_entries.size(); i++)
+		{
+			if(m_groups.empty() || m_entries[i].gate != m_entries[m_groups.back().first].gate)
+			{
+				m_groups.emplace_back();
+				m_groups.back().first = i;
+				m_groups.back().gated = m_entries[i].gate != "None";
+				if(m_groups.back().gated)
+				{
+					m_groups.back().gate.Compile(m_entries[i].gate, cuts);
+					ngates++;
+				}
+			}
+			m_groups.back().last = i+1;
+			if(m_groups.back().gated)
+				ngated++;
+		}
+
+		EVB_INFO("Read {0} histograms ({1} gated, on {2} gates) from spec file {3}.", m_entries.size(), ngated, ngates, filename);
+		return !m_entries.empty();
+	}
+
+	bool HistogramSpec::ParseLine(const std::string& line, Entry& entry)
+	{
+		std::istringstream tokens(line);
+		std::vector<std::string> columns;
+		std::string column;
+		while(tokens>>column)
+			columns.push_back(column);
+		if(columns.size() != 6 && columns.size() != 10)
+			return false;
+
+		entry.name = columns[0];
+		entry.gate = columns[1];
+
+		try
+		{
+			entry.binsx = std::stoi(columns[2]);
+			entry.minx = std::stod(columns[3]);
+			entry.maxx = std::stod(columns[4]);
+			if(columns.size() == 10)
+			{
+				entry.binsy = std::stoi(columns[6]);
+				entry.miny = std::stod(columns[7]);
+				entry.maxy = std::stod(columns[8]);
+			}
+		}
+		catch(std::exception&)
+		{
+			return false;
+		}
+
+		entry.dimension = columns.size() == 10 ? 2 : 1;
+		if(!entry.x.Compile(columns[5]))
+			return false;
+		if(entry.dimension == 2 && !entry.y.Compile(columns[9]))
+			return false;
+		return entry.binsx > 0 && (entry.dimension == 1 || entry.binsy > 0);
+	}
+
+	/*Book the histograms of the plan, keeping their handles; registries booked like hists can then be filled too*/
+	void HistogramSpec::Book(HistogramRegistry& hists)
+	{
+		for(auto& entry : m_entries)
+		{
+			if(entry.dimension == 1)
+				entry.handle1D = hists.Book(entry.name, entry.binsx, entry.minx, entry.maxx);
+			else
+				entry.handle2D = hists.Book(entry.name, entry.binsx, entry.minx, entry.maxx, entry.binsy, entry.miny, entry.maxy);
+		}
+	}
+
+	/*insideMask is the event's mask from CutHandler::GetInsideMask, with the cut list the gates were compiled against*/
+	void HistogramSpec::Fill(const ProcessedEvent& event, uint64_t insideMask, HistogramRegistry& hists) const
+	{
+		for(const auto& group : m_groups)
+		{
+			if(group.gated && !group.gate.Evaluate(insideMask))
+				continue;
+			for(std::size_t i=group.first; i<group.last; i++)
+			{
+				const Entry& entry = m_entries[i];
+				if(entry.dimension == 1)
+					hists.Fill(entry.handle1D, entry.x.Evaluate(event));
+				else
+					hists.Fill(entry.handle2D, entry.x.Evaluate(event), entry.y.Evaluate(event));
+			}
+		}
+	}
+
+}
@@ -0,0 +1,63 @@
+/*
+	HistogramSpec.h
+	Histograms defined in a file rather than in code, so that the set plotted can be changed (i.e. expensive
+	diagnostics pruned for an experiment) without rebuilding. Each line of the file defines one histogram:
+
+		Name Gate BinsX MinX MaxX VarX [BinsY MinY MaxY VarY]
+
+	where the Var columns are EventExpressions over the ProcessedEvent fields (see EventVariables.h), and Gate is
+	None (every event) or a CutGate over the cut list (i.e. Cut for events inside every cut, protons, or
+	protons&!deuterons). The first line is a header; lines starting with # are comments. The file is read once into
+	a flat fill plan: the expressions and gates compiled and the histograms booked, grouped by gate (ungated
+	first), so filling an event is a walk down the plan testing each gate once against the event's cut mask.
+*/
+#ifndef HISTOGRAMSPEC_H
+#define HISTOGRAMSPEC_H
+
+#include "EventVariables.h"
+#include "HistogramRegistry.h"
+#include "CutGate.h"
+
+namespace EventBuilder {
+
+	class HistogramSpec
+	{
+	public:
+		HistogramSpec();
+		bool ReadFile(const std::string& filename, const CutHandler& cuts);
+		void Book(HistogramRegistry& hists);
+		void Fill(const ProcessedEvent& event, uint64_t insideMask, HistogramRegistry& hists) const;
+		inline bool IsValid() const { return !m_entries.empty(); }
+		inline bool UsesCuts() const { return !m_groups.empty() && m_groups.back().gated; }
+		inline std::size_t GetSize() const { return m_entries.size(); }
+
+	private:
+		struct Entry
+		{
+			std::string name;
+			std::string gate; //text of the gate, None for every event
+			int dimension = 1;
+			int binsx = 0, binsy = 0;
+			double minx = 0.0, maxx = 0.0, miny = 0.0, maxy = 0.0;
+			EventExpression x, y;
+			HistogramRegistry::Handle1D handle1D;
+			HistogramRegistry::Handle2D handle2D;
+		};
+
+		//Entries [first, last) of the plan, all with the same gate
+		struct Group
+		{
+			CutGate gate;
+			bool gated = false;
+			std::size_t first = 0, last = 0;
+		};
+
+		bool ParseLine(const std::string& line, Entry& entry);
+
+		std::vector<Entry> m_entries; //by group
+		std::vector<Group> m_groups; //the ungated group (if any) first
+	};
+
+}
+
+#endif
@@ -0,0 +1,120 @@
+/*
+	HitBatch.h
+	Structure-of-arrays batch of hits, the unit in which hits move from the CompassFile decoder through the
+	HitMerger to the event builder. Each field is its own column, so a pass over one field (i.e. the merger
+	comparing timestamps) walks contiguous memory, and the CoMPASS fields the builder never uses (calibrated
+	energy, waveform info) aren't carried at all. The container style interface (size, clear, reserve, ...)
+	lets batches be handled like the other batch types of the pipelined conversion.
+*/
+#ifndef HITBATCH_H
+#define HITBATCH_H
+
+#include "CompassHit.h"
+#include <algorithm>
+
+namespace EventBuilder {
+
+	struct HitBatch
+	{
+		std::vector<uint64_t> timestamp; //ps, shifted
+		std::vector<uint16_t> board;
+		std::vector<uint16_t> channel;
+		std::vector<uint16_t> energy;
+		std::vector<uint16_t> energyShort;
+		std::vector<uint32_t> flags;
+
+		inline std::size_t size() const { return timestamp.size(); }
+		inline bool empty() const { return timestamp.empty(); }
+		inline int GetGlobalChannel(std::size_t index) const { return channel[index] + board[index]*16; }
+
+		void resize(std::size_t n)
+		{
+			timestamp.resize(n);
+			board.resize(n);
+			channel.resize(n);
+			energy.resize(n);
+			energyShort.resize(n);
+			flags.resize(n);
+		}
+
+		void reserve(std::size_t n)
+		{
+			timestamp.reserve(n);
+			board.reserve(n);
+			channel.reserve(n);
+			energy.reserve(n);
+			energyShort.reserve(n);
+			flags.reserve(n);
+		}
+
+		void clear() { resize(0); }
+
+		//Append the hits [first, first + count) of another batch, column by column
+		void append(const HitBatch& other, std::size_t first, std::size_t count)
+		{
+			timestamp.insert(timestamp.end(), other.timestamp.begin() + first, other.timestamp.begin() + first + count);
+			board.insert(board.end(), other.board.begin() + first, other.board.begin() + first + count);
+			channel.insert(channel.end(), other.channel.begin() + first, other.channel.begin() + first + count);
+			energy.insert(energy.end(), other.energy.begin() + first, other.energy.begin() + first + count);
+			energyShort.insert(energyShort.end(), other.energyShort.begin() + first, other.energyShort.begin() + first + count);
+			flags.insert(flags.end(), other.flags.begin() + first, other.flags.begin() + first + count);
+		}
+
+		//Move the hits [first, first + count) to the front of the batch
+		void moveToFront(std::size_t first, std::size_t count)
+		{
+			if(first == 0 || count == 0)
+				return;
+			std::copy(timestamp.begin() + first, timestamp.begin() + first + count, timestamp.begin());
+			std::copy(board.begin() + first, board.begin() + first + count, board.begin());
+			std::copy(channel.begin() + first, channel.begin() + first + count, channel.begin());
+			std::copy(energy.begin() + first, energy.begin() + first + count, energy.begin());
+			std::copy(energyShort.begin() + first, energyShort.begin() + first + count, energyShort.begin());
+			std::copy(flags.begin() + first, flags.begin() + first + count, flags.begin());
+		}
+
+		//Move the hit at from back to to (to <= from), shifting the hits [to, from) up by one
+		void moveBack(std::size_t from, std::size_t to)
+		{
+			if(from == to)
+				return;
+			std::rotate(timestamp.begin() + to, timestamp.begin() + from, timestamp.begin() + from + 1);
+			std::rotate(board.begin() + to, board.begin() + from, board.begin() + from + 1);
+			std::rotate(channel.begin() + to, channel.begin() + from, channel.begin() + from + 1);
+			std::rotate(energy.begin() + to, energy.begin() + from, energy.begin() + from + 1);
+			std::rotate(energyShort.begin() + to, energyShort.begin() + from, energyShort.begin() + from + 1);
+			std::rotate(flags.begin() + to, flags.begin() + from, flags.begin() + from + 1);
+		}
+
+		//Append the hits of another batch in the order given by a list of indices into it
+		void gather(const HitBatch& other, const std::vector<uint32_t>& order)
+		{
+			std::size_t start = size();
+			resize(start + order.size());
+			for(std::size_t i=0; i<order.size(); i++)
+			{
+				uint32_t index = order[i];
+				timestamp[start + i] = other.timestamp[index];
+				board[start + i] = other.board[index];
+				channel[start + i] = other.channel[index];
+				energy[start + i] = other.energy[index];
+				energyShort[start + i] = other.energyShort[index];
+				flags[start + i] = other.flags[index];
+			}
+		}
+
+		//Copy of a single hit as a record, for the raw tree branches
+		void GetHit(std::size_t index, CompassHit& hit) const
+		{
+			hit.timestamp = timestamp[index];
+			hit.board = board[index];
+			hit.channel = channel[index];
+			hit.energy = energy[index];
+			hit.energyShort = energyShort[index];
+			hit.flags = flags[index];
+		}
+	};
+
+}
+
+#endif
@@ -0,0 +1,206 @@
+/*
+	HitMerger.cpp
+	k-way merge of the CompassFiles which make up a run. Each file is individually time ordered, so the
+	run is ordered by repeatedly taking the earliest current hit across all of the files. Files are held
+	by index in a binary min-heap keyed on the timestamp of their current hit. Hits are merged into a
+	HitBatch: the file at the top of the heap hands over the whole run of hits that come before the current
+	hit of the runner up in one copy, so the heap is only touched once per run rather than once per hit.
+	Ties are broken on file index, giving the same order as a linear scan of the file list.
+
+	In Block mode hits are instead ordered a block at a time: every file hands over its hits earlier than
+	the end of the file's current batch which comes first, the runs are concatenated, and the block is
+	put in time order with an LSD radix sort on the timestamps. There's no per-hit comparison at all, which
+	pays off when many low rate files make the heap deep. Concatenating in file order, sorting stably, and
+	leaving hits at the end time of a block in the files after the one that ends it keeps the tie order of the heap.
+*/
+#include "EventBuilder.h"
+#include "HitMerger.h"
+#include <algorithm>
+#include <limits>
+
+namespace EventBuilder {
+
+	HitMerger::HitMerger() :
+		m_files(nullptr), m_mode(MergeMode::Heap), m_blockPos(0)
+	{
+	}
+
+	HitMerger::~HitMerger() {}
+
+	/*Pull the first hit from every file and build the heap from the files that have data*/
+	void HitMerger::Init(std::vector<CompassFile>& files)
+	{
+		m_files = &files;
+		m_heap.clear();
+		m_heap.reserve(files.size());
+		m_block.clear();
+		m_sorted.clear();
+		m_blockPos = 0;
+		for(unsigned int i=0; i<files.size(); i++)
+		{
+			files[i].GetNextHit();
+			if(!files[i].IsEOF())
+				m_heap.push_back(i);
+		}
+		if(m_mode == MergeMode::Block)
+			return;
+		//std heaps keep the "largest" element at the front, so order by lateness
+		std::make_heap(m_heap.begin(), m_heap.end(), [this](unsigned int a, unsigned int b) { return IsLater(a, b); });
+	}
+
+	bool HitMerger::IsLater(unsigned int a, unsigned int b) const
+	{
+		uint64_t ta = (*m_files)[a].GetCurrentTimestamp();
+		uint64_t tb = (*m_files)[b].GetCurrentTimestamp();
+		return ta > tb || (ta == tb && a > b);
+	}
+
+	/*Restore the heap after the file at the top has moved on to its next hit*/
+	void HitMerger::SiftDown()
+	{
+		std::size_t size = m_heap.size();
+		std::size_t pos = 0;
+		unsigned int moving = m_heap[0];
+		while(true)
+		{
+			std::size_t child = 2*pos + 1;
+			if(child >= size)
+				break;
+			if(child + 1 < size && IsLater(m_heap[child], m_heap[child+1]))
+				child++;
+			if(!IsLater(moving, m_heap[child]))
+				break;
+			m_heap[pos] = m_heap[child];
+			pos = child;
+		}
+		m_heap[pos] = moving;
+	}
+
+	/*
+		Appends up to maxHits of the next hits of the run, in time order, to hits and returns the number added;
+		0 once every file is exhausted. The run of hits taken from the top file ends at its first hit that is
+		later than the current hit of the runner up (the earlier child of the top), found by a scan over the
+		timestamp column of the file's batch, or at the end of that batch.
+	*/
+	std::size_t HitMerger::GetNextHits(HitBatch& hits, std::size_t maxHits)
+	{
+		return m_mode == MergeMode::Block ? GetNextHitsBlock(hits, maxHits) : GetNextHitsHeap(hits, maxHits);
+	}
+
+	std::size_t HitMerger::GetNextHitsHeap(HitBatch& hits, std::size_t maxHits)
+	{
+		std::size_t nhits = 0;
+		while(nhits < maxHits && !m_heap.empty())
+		{
+			unsigned int top = m_heap[0];
+			CompassFile& file = (*m_files)[top];
+			const HitBatch& batch = file.GetHitBatch();
+			std::size_t first = file.GetHitIndex();
+			std::size_t last = std::min(file.GetBatchSize(), first + (maxHits - nhits));
+			std::size_t end = last;
+			if(m_heap.size() > 1)
+			{
+				unsigned int runnerUp = m_heap[1];
+				if(m_heap.size() > 2 && IsLater(runnerUp, m_heap[2]))
+					runnerUp = m_heap[2];
+				uint64_t limit = (*m_files)[runnerUp].GetCurrentTimestamp();
+				const uint64_t* times = batch.timestamp.data();
+				end = first + 1; //the current hit is the earliest of the run by construction
+				if(top < runnerUp)
+					while(end < last && times[end] <= limit) end++;
+				else
+					while(end < last && times[end] < limit) end++;
+			}
+
+			hits.append(batch, first, end - first);
+			nhits += end - first;
+			file.SkipHits(end - first);
+			if(file.IsEOF())
+			{
+				m_heap[0] = m_heap.back();
+				m_heap.pop_back();
+			}
+			if(!m_heap.empty())
+				SiftDown();
+		}
+		return nhits;
+	}
+
+	/*Block mode version of GetNextHits(): hands out the sorted block, making a new one whenever it runs out*/
+	std::size_t HitMerger::GetNextHitsBlock(HitBatch& hits, std::size_t maxHits)
+	{
+		std::size_t nhits = 0;
+		while(nhits < maxHits)
+		{
+			if(m_blockPos == m_sorted.size())
+			{
+				if(!FillBlock())
+					break;
+				continue; //an empty block is refilled, not handed out
+			}
+			std::size_t count = std::min(maxHits - nhits, m_sorted.size() - m_blockPos);
+			hits.append(m_sorted, m_blockPos, count);
+			m_blockPos += count;
+			nhits += count;
+		}
+		return nhits;
+	}
+
+	/*
+		Make the next block. The block ends at the earliest last hit of the decoded batches (the limit), ties going
+		to the lowest file index (the limiting file): no file can have a hit earlier than that beyond its current
+		batch, so taking every hit before the limit from each file gives a complete, time contiguous block. Hits at
+		the limit are taken from the limiting file and the files before it, which hold no more hits at the limit
+		beyond their batches, but left in the files after it, which may; so hits of equal time still come out in
+		file order, as from the heap. The limiting file hands over its whole remaining batch unconditionally, so every
+		block makes progress even when a batch isn't in time order (the binary searches then merely misplace hits, as
+		the heap would hand them out late). Each other file's run is found by a binary search of its timestamp column.
+		Returns false once every file is exhausted.
+	*/
+	bool HitMerger::FillBlock()
+	{
+		m_block.clear();
+		m_blockPos = 0;
+		if(m_heap.empty())
+		{
+			m_sorted.clear();
+			return false;
+		}
+
+		uint64_t limit = std::numeric_limits<uint64_t>::max();
+		unsigned int limitIndex = 0;
+		for(auto index : m_heap)
+		{
+			const CompassFile& file = (*m_files)[index];
+			uint64_t last = file.GetHitBatch().timestamp[file.GetBatchSize() - 1];
+			if(last < limit) //m_heap is in file order, so the first file at the limit is kept
+			{
+				limit = last;
+				limitIndex = index;
+			}
+		}
+
+		for(auto index : m_heap)
+		{
+			CompassFile& file = (*m_files)[index];
+			const uint64_t* times = file.GetHitBatch().timestamp.data();
+			const uint64_t* first = times + file.GetHitIndex();
+			const uint64_t* last = times + file.GetBatchSize();
+			const uint64_t* end = last;
+			if(index < limitIndex)
+				end = std::upper_bound(first, last, limit);
+			else if(index > limitIndex)
+				end = std::lower_bound(first, last, limit);
+			std::size_t count = end - first;
+			if(count == 0)
+				continue;
+			m_block.append(file.GetHitBatch(), file.GetHitIndex(), count);
+			file.SkipHits(count);
+		}
+		m_heap.erase(std::remove_if(m_heap.begin(), m_heap.end(), [this](unsigned int index) { return (*m_files)[index].IsEOF(); }), m_heap.end());
+
+		m_sorter.Sort(m_block, m_sorted);
+		return true;
+	}
+
+}
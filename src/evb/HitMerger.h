@@ -0,0 +1,60 @@
+/*
+	HitMerger.h
+	k-way merge of the CompassFiles which make up a run. Each file is individually time ordered, so the
+	run is ordered by repeatedly taking the earliest current hit across all of the files. Files are held
+	by index in a binary min-heap keyed on the timestamp of their current hit. Hits are merged into a
+	HitBatch: the file at the top of the heap hands over the whole run of hits that come before the current
+	hit of the runner up in one copy, so the heap is only touched once per run rather than once per hit.
+	Ties are broken on file index, giving the same order as a linear scan of the file list.
+
+	In Block mode hits are instead ordered a block at a time: every file hands over its hits earlier than
+	the end of the file's current batch which comes first, the runs are concatenated, and the block is
+	put in time order with an LSD radix sort on the timestamps. There's no per-hit comparison at all, which
+	pays off when many low rate files make the heap deep. Concatenating in file order, sorting stably, and
+	leaving hits at the end time of a block in the files after the one that ends it keeps the tie order of the heap.
+*/
+#ifndef HITMERGER_H
+#define HITMERGER_H
+
+#include "CompassFile.h"
+#include "HitSorter.h"
+
+namespace EventBuilder {
+
+	class HitMerger
+	{
+	public:
+		enum MergeMode
+		{
+			Heap,
+			Block
+		};
+
+		HitMerger();
+		~HitMerger();
+		void Init(std::vector<CompassFile>& files);
+		std::size_t GetNextHits(HitBatch& hits, std::size_t maxHits);
+		inline void SetMode(MergeMode mode) { m_mode = mode; } //takes effect at the next Init()
+		inline MergeMode GetMode() const { return m_mode; }
+
+	private:
+		bool IsLater(unsigned int a, unsigned int b) const;
+		void SiftDown();
+		std::size_t GetNextHitsHeap(HitBatch& hits, std::size_t maxHits);
+		std::size_t GetNextHitsBlock(HitBatch& hits, std::size_t maxHits);
+		bool FillBlock();
+
+		std::vector<CompassFile>* m_files; //NOT owned by HitMerger
+		std::vector<unsigned int> m_heap; //indices into m_files of the files with hits left; a heap on the current hit in Heap mode, in file order in Block mode
+		MergeMode m_mode;
+
+		//Block mode
+		HitBatch m_block; //hits of the current block, in file order
+		HitBatch m_sorted; //hits of the current block, in time order
+		std::size_t m_blockPos; //next hit of m_sorted to hand out
+		HitSorter m_sorter;
+	};
+
+}
+
+#endif
@@ -0,0 +1,78 @@
+/*
+	HitSorter.cpp
+	Puts a HitBatch in time order with an LSD radix sort on the timestamps. The keys are the timestamps less
+	the earliest of the batch, so only as many digits as the time span of the batch needs are sorted, and a
+	digit that is the same for every hit is skipped. Every pass is stable, so hits with equal timestamps keep
+	their order in the batch. The scratch space is kept between calls.
+*/
+#include "EventBuilder.h"
+#include "HitSorter.h"
+#include <algorithm>
+#include <array>
+
+namespace EventBuilder {
+
+	HitSorter::HitSorter() {}
+
+	HitSorter::~HitSorter() {}
+
+	void HitSorter::Sort(const HitBatch& hits, HitBatch& sorted)
+	{
+		constexpr std::size_t nbuckets = std::size_t(1) << s_radixBits;
+		constexpr uint64_t mask = nbuckets - 1;
+
+		sorted.clear();
+		std::size_t n = hits.size();
+		if(n == 0)
+			return;
+
+		const uint64_t* times = hits.timestamp.data();
+		auto range = std::minmax_element(times, times + n);
+		uint64_t base = *range.first;
+		uint64_t span = *range.second - base;
+
+		m_keys.resize(n);
+		m_order.resize(n);
+		for(std::size_t i=0; i<n; i++)
+		{
+			m_keys[i] = times[i] - base;
+			m_order[i] = i;
+		}
+
+		if(n < s_minRadixHits)
+			std::stable_sort(m_order.begin(), m_order.end(), [times](uint32_t a, uint32_t b) { return times[a] < times[b]; });
+		else
+		{
+			m_keyScratch.resize(n);
+			m_orderScratch.resize(n);
+			std::array<std::size_t, nbuckets> counts;
+			for(int shift=0; shift<64 && (span >> shift) != 0; shift += s_radixBits)
+			{
+				counts.fill(0);
+				for(std::size_t i=0; i<n; i++)
+					counts[(m_keys[i] >> shift) & mask]++;
+				if(counts[(m_keys[0] >> shift) & mask] == n)
+					continue;
+
+				std::size_t offset = 0;
+				for(auto& count : counts)
+				{
+					std::size_t bucket = count;
+					count = offset;
+					offset += bucket;
+				}
+				for(std::size_t i=0; i<n; i++)
+				{
+					std::size_t pos = counts[(m_keys[i] >> shift) & mask]++;
+					m_keyScratch[pos] = m_keys[i];
+					m_orderScratch[pos] = m_order[i];
+				}
+				m_keys.swap(m_keyScratch);
+				m_order.swap(m_orderScratch);
+			}
+		}
+
+		sorted.gather(hits, m_order);
+	}
+
+}
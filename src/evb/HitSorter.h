@@ -0,0 +1,31 @@
+/*
+	HitSorter.h
+	Puts a HitBatch in time order with an LSD radix sort on the timestamps. The keys are the timestamps less
+	the earliest of the batch, so only as many digits as the time span of the batch needs are sorted, and a
+	digit that is the same for every hit is skipped. Every pass is stable, so hits with equal timestamps keep
+	their order in the batch. The scratch space is kept between calls.
+*/
+#ifndef HITSORTER_H
+#define HITSORTER_H
+
+#include "HitBatch.h"
+
+namespace EventBuilder {
+
+	class HitSorter
+	{
+	public:
+		HitSorter();
+		~HitSorter();
+		void Sort(const HitBatch& hits, HitBatch& sorted); //sorted is replaced; at most 2^32 hits
+
+	private:
+		std::vector<uint64_t> m_keys, m_keyScratch; //timestamps relative to the start of the batch
+		std::vector<uint32_t> m_order, m_orderScratch; //index in the batch of each key
+		static constexpr int s_radixBits = 11;
+		static constexpr std::size_t s_minRadixHits = 256; //smaller batches are sorted by comparison
+	};
+
+}
+
+#endif
@@ -0,0 +1,115 @@
+/*
+	RawTreeReader.cpp
+	Hit source for building events from a raw_root file (the Data tree written by Convert2RawRoot) instead of the
+	binaries. The tree already holds the shifted hits of the run in time order, so hits are read straight into
+	HitBatches: no archive to unpack and no merge. Only the hit branches are read, through a large TTreeCache.
+*/
+#include "EventBuilder.h"
+#include "RawTreeReader.h"
+#include <TKey.h>
+
+namespace EventBuilder {
+
+	RawTreeReader::RawTreeReader() :
+		m_file(nullptr), m_tree(nullptr), m_nEntries(0), m_entry(0)
+	{
+	}
+
+	RawTreeReader::~RawTreeReader()
+	{
+		Close();
+	}
+
+	bool RawTreeReader::Open(const std::string& filename)
+	{
+		Close();
+		m_file = TFile::Open(filename.c_str(), "READ");
+		if(m_file == nullptr || !m_file->IsOpen())
+		{
+			EVB_ERROR("Unable to open raw_root file {0} at RawTreeReader::Open()!", filename);
+			Close();
+			return false;
+		}
+
+		m_tree = (TTree*) m_file->Get("Data");
+		if(m_tree == nullptr)
+		{
+			EVB_ERROR("No Data tree in raw_root file {0} at RawTreeReader::Open()!", filename);
+			Close();
+			return false;
+		}
+
+		m_tree->SetBranchStatus("*", false);
+		for(const char* name : { "Board", "Channel", "Energy", "EnergyShort", "Timestamp", "Flags" })
+			m_tree->SetBranchStatus(name, true);
+		m_tree->SetBranchAddress("Board", &m_hit.board);
+		m_tree->SetBranchAddress("Channel", &m_hit.channel);
+		m_tree->SetBranchAddress("Energy", &m_hit.energy);
+		m_tree->SetBranchAddress("EnergyShort", &m_hit.energyShort);
+		m_tree->SetBranchAddress("Timestamp", &m_hit.timestamp);
+		m_tree->SetBranchAddress("Flags", &m_hit.flags);
+		m_tree->SetCacheSize(s_cacheSize);
+		m_tree->AddBranchToCache("*", true);
+		m_tree->StopCacheLearningPhase();
+
+		m_nEntries = m_tree->GetEntries();
+		m_entry = 0;
+		return true;
+	}
+
+	void RawTreeReader::Close()
+	{
+		if(m_file != nullptr)
+		{
+			m_file->Close();
+			delete m_file;
+		}
+		m_file = nullptr;
+		m_tree = nullptr;
+		m_nEntries = 0;
+		m_entry = 0;
+	}
+
+	/*Appends up to maxHits of the next hits of the tree to hits and returns the number added; 0 at the end of the tree*/
+	std::size_t RawTreeReader::GetNextHits(HitBatch& hits, std::size_t maxHits)
+	{
+		if(m_tree == nullptr)
+			return 0;
+
+		std::size_t start = hits.size();
+		std::size_t nhits = std::min<Long64_t>(maxHits, m_nEntries - m_entry);
+		hits.resize(start + nhits);
+		for(std::size_t i=start; i<start+nhits; i++)
+		{
+			m_tree->GetEntry(m_entry++);
+			hits.timestamp[i] = m_hit.timestamp;
+			hits.board[i] = m_hit.board;
+			hits.channel[i] = m_hit.channel;
+			hits.energy[i] = m_hit.energy;
+			hits.energyShort[i] = m_hit.energyShort;
+			hits.flags[i] = m_hit.flags;
+		}
+		return nhits;
+	}
+
+	/*The scaler counts written alongside the Data tree, so that they carry over to the built outputs*/
+	void RawTreeReader::ReadScalers(std::unordered_map<std::string, TParameter<Long64_t>>& scalers) const
+	{
+		if(m_file == nullptr)
+			return;
+
+		TIter next(m_file->GetListOfKeys());
+		TKey* key;
+		while((key = (TKey*) next()))
+		{
+			if(std::string(key->GetClassName()).rfind("TParameter", 0) != 0)
+				continue;
+			TObject* object = key->ReadObj();
+			auto parameter = dynamic_cast<TParameter<Long64_t>*>(object); //null for parameters of other types
+			if(parameter != nullptr)
+				scalers[parameter->GetName()] = *parameter;
+			delete object;
+		}
+	}
+
+}
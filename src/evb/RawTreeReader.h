@@ -0,0 +1,39 @@
+/*
+	RawTreeReader.h
+	Hit source for building events from a raw_root file (the Data tree written by Convert2RawRoot) instead of the
+	binaries. The tree already holds the shifted hits of the run in time order, so hits are read straight into
+	HitBatches: no archive to unpack and no merge. Only the hit branches are read, through a large TTreeCache.
+*/
+#ifndef RAWTREEREADER_H
+#define RAWTREEREADER_H
+
+#include "HitBatch.h"
+#include <TParameter.h>
+
+namespace EventBuilder {
+
+	class RawTreeReader
+	{
+	public:
+		RawTreeReader();
+		~RawTreeReader();
+		bool Open(const std::string& filename);
+		void Close();
+		std::size_t GetNextHits(HitBatch& hits, std::size_t maxHits);
+		void ReadScalers(std::unordered_map<std::string, TParameter<Long64_t>>& scalers) const;
+		inline bool IsOpen() const { return m_tree != nullptr; }
+		inline uint64_t GetNumberOfHits() const { return m_nEntries; }
+
+	private:
+		TFile* m_file;
+		TTree* m_tree; //owned by m_file
+		Long64_t m_nEntries;
+		Long64_t m_entry; //next entry to read
+		CompassHit m_hit; //branch variables
+
+		static constexpr Long64_t s_cacheSize = 256*1024*1024; //bytes
+	};
+
+}
+
+#endif
@@ -15,20 +15,24 @@
 // Testing the main branch push here!!
 namespace EventBuilder {
 
+    //Signed time of hit a relative to hit b in ns, taken from the integer timestamps so that it is exact on any run length
+    static inline double RelativeTime(const DetectorHit& a, const DetectorHit& b)
+    {
+        return int64_t(a.Timestamp - b.Timestamp)/1.0e3;
+    }
+
     /*Constructor takes in kinematic parameters for generating focal plane weights*/
     SFPAnalyzer::SFPAnalyzer(int zt, int at, int zp, int ap, int ze, int ae, double ep,
                                 double angle, double b)
     {
         zfp = Delta_Z(zt, at, zp, ap, ze, ae, ep, angle, b);
         event_address = new CoincEvent();
-        rootObj = new THashTable();
         GetWeights();
+        BookHistograms();
     }
    
     SFPAnalyzer::~SFPAnalyzer()
     {
-        rootObj->Clear();
-        delete rootObj;
         delete event_address;
     }
    
@@ -49,33 +53,19 @@ namespace EventBuilder {
         EVB_INFO("Calculated X-Avg weights of w1={0} and w2={1}",w1,w2);
     }
    
-    /*2D histogram fill wrapper for use with THashTable (faster)*/
-    void SFPAnalyzer::MyFill(const std::string& name, int binsx, double minx, double maxx, double valuex,
-                                int binsy, double miny, double maxy, double valuey)
-    {
-        TH2F *histo = (TH2F*) rootObj->FindObject(name.c_str());
-        if(histo != nullptr)
-            histo->Fill(valuex, valuey);
-        else 
-        {
-            TH2F *h = new TH2F(name.c_str(), name.c_str(), binsx, minx, maxx, binsy, miny, maxy);
-            h->Fill(valuex, valuey);
-            rootObj->Add(h);
-        }
-    }
-   
-    /*1D histogram fill wrapper for use with THashTable (faster)*/
-    void SFPAnalyzer::MyFill(const std::string& name, int binsx, double minx, double maxx, double valuex)
+    /*The histograms are booked up front, and filled through their handles*/
+    void SFPAnalyzer::BookHistograms()
     {
-        TH1F *histo = (TH1F*) rootObj->FindObject(name.c_str());
-        if(histo != nullptr)
-            histo->Fill(valuex);
-        else 
-        {
-            TH1F *h = new TH1F(name.c_str(), name.c_str(), binsx, minx, maxx);
-            h->Fill(valuex);
-            rootObj->Add(h);
-        }
+        h_x1 = m_histograms.Book("x1",1200,-300,300);
+        h_x1_anodeBack = m_histograms.Book("x1 vs anodeBack",600,-300,300,512,0,4096);
+        h_x2 = m_histograms.Book("x2",1200,-300,300);
+        h_x2_anodeBack = m_histograms.Book("x2 vs anodeBack",600,-300,300,512,0,4096);
+        for(int i=0; i<5; i++)
+            h_cebraE[i] = m_histograms.Book("CebraE"+std::to_string(i),4096,0,4096);
+        h_anodeBack_scintLeft = m_histograms.Book("anodeBack vs scintLeft",512,0,4096,512,0,4096);
+        h_xavg = m_histograms.Book("xavg",1200,-300,300);
+        h_xavg_theta = m_histograms.Book("xavg vs theta",600,-300,300,314,0,3.14);
+        h_x1_x2 = m_histograms.Book("x1 vs x2",600,-300,300,600,-300,300);
     }
    
     void SFPAnalyzer::AnalyzeEvent(CoincEvent& event)
@@ -142,23 +132,23 @@ namespace EventBuilder {
         }  
         if(!event.focalPlane.delayFL.empty() && !event.focalPlane.delayFR.empty())
         {
-            pevent.fp1_tdiff = (event.focalPlane.delayFL[0].Time-event.focalPlane.delayFR[0].Time)*0.5;
+            pevent.fp1_tdiff = RelativeTime(event.focalPlane.delayFL[0], event.focalPlane.delayFR[0])*0.5;
             pevent.fp1_tsum = (event.focalPlane.delayFL[0].Time+event.focalPlane.delayFR[0].Time);
             pevent.fp1_tcheck = (pevent.fp1_tsum)/2.0-pevent.anodeFrontTime;
             pevent.delayFrontMaxTime = std::max(event.focalPlane.delayFL[0].Time, event.focalPlane.delayFR[0].Time);
             pevent.x1 = pevent.fp1_tdiff*1.0/2.10; //position from time, based on total delay
-            MyFill("x1",1200,-300,300,pevent.x1);
-            MyFill("x1 vs anodeBack",600,-300,300,pevent.x1,512,0,4096,pevent.anodeBack);
+            m_histograms.Fill(h_x1,pevent.x1);
+            m_histograms.Fill(h_x1_anodeBack,pevent.x1,pevent.anodeBack);
         }
         if(!event.focalPlane.delayBL.empty() && !event.focalPlane.delayBR.empty())
         {
-            pevent.fp2_tdiff = (event.focalPlane.delayBL[0].Time-event.focalPlane.delayBR[0].Time)*0.5;
+            pevent.fp2_tdiff = RelativeTime(event.focalPlane.delayBL[0], event.focalPlane.delayBR[0])*0.5;
             pevent.fp2_tsum = (event.focalPlane.delayBL[0].Time+event.focalPlane.delayBR[0].Time);
             pevent.fp2_tcheck = (pevent.fp2_tsum)/2.0-pevent.anodeBackTime;
             pevent.delayBackMaxTime = std::max(event.focalPlane.delayBL[0].Time, event.focalPlane.delayBR[0].Time);
             pevent.x2 = pevent.fp2_tdiff*1.0/1.98; //position from time, based on total delay
-            MyFill("x2",1200,-300,300,pevent.x2);
-            MyFill("x2 vs anodeBack",600,-300,300,pevent.x2,512,0,4096,pevent.anodeBack);
+            m_histograms.Fill(h_x2,pevent.x2);
+            m_histograms.Fill(h_x2_anodeBack,pevent.x2,pevent.anodeBack);
         }
         /*SABRE data*/
     /*  for(int j=0; j<5; j++)
@@ -269,15 +259,15 @@ namespace EventBuilder {
 
   
         if(pevent.cebraE[0]!=-1){ 
-            MyFill("CebraE0",4096,0,4096,pevent.cebraE[0]);}
+            m_histograms.Fill(h_cebraE[0],pevent.cebraE[0]);}
         if(pevent.cebraE[1]!=-1){ 
-            MyFill("CebraE1",4096,0,4096,pevent.cebraE[1]);}
+            m_histograms.Fill(h_cebraE[1],pevent.cebraE[1]);}
         if(pevent.cebraE[2]!=-1){ 
-            MyFill("CebraE2",4096,0,4096,pevent.cebraE[2]);}
+            m_histograms.Fill(h_cebraE[2],pevent.cebraE[2]);}
         if(pevent.cebraE[3]!=-1){ 
-            MyFill("CebraE3",4096,0,4096,pevent.cebraE[3]);}
+            m_histograms.Fill(h_cebraE[3],pevent.cebraE[3]);}
         if(pevent.cebraE[4]!=-1){ 
-            MyFill("CebraE4",4096,0,4096,pevent.cebraE[4]);}
+            m_histograms.Fill(h_cebraE[4],pevent.cebraE[4]);}
 
 
          
@@ -285,25 +275,25 @@ namespace EventBuilder {
   
 
         /*Make some histograms and xavg*/
-        MyFill("anodeBack vs scintLeft",512,0,4096,pevent.scintLeft,512,0,4096,pevent.anodeBack);
+        m_histograms.Fill(h_anodeBack_scintLeft,pevent.scintLeft,pevent.anodeBack);
         if(pevent.x1 != -1e6 && pevent.x2 != -1e6)
         {
             pevent.xavg = pevent.x1*w1+pevent.x2*w2;
-            MyFill("xavg",1200,-300,300,pevent.xavg);
+            m_histograms.Fill(h_xavg,pevent.xavg);
             if((pevent.x2-pevent.x1) > 0)
                 pevent.theta = std::atan((pevent.x2-pevent.x1)/36.0);
             else if((pevent.x2-pevent.x1) < 0)
                 pevent.theta = TMath::Pi() + std::atan((pevent.x2-pevent.x1)/36.0);
             else 
 				pevent.theta = TMath::Pi()/2.0;
-			MyFill("xavg vs theta",600,-300,300,pevent.xavg,314,0,3.14,pevent.theta);
-			MyFill("x1 vs x2",600,-300,300,pevent.x1,600,-300,300,pevent.x2);
+			m_histograms.Fill(h_xavg_theta,pevent.xavg,pevent.theta);
+			m_histograms.Fill(h_x1_x2,pevent.x1,pevent.x2);
 
         }
-        if(pevent.anodeFrontTime != -1 && pevent.scintRightTime != -1)
-            pevent.fp1_y = pevent.anodeFrontTime-pevent.scintRightTime;
-        if(pevent.anodeBackTime != -1 && pevent.scintRightTime != -1)
-            pevent.fp2_y = pevent.anodeBackTime-pevent.scintRightTime;
+        if(!event.focalPlane.anodeF.empty() && !event.focalPlane.scintR.empty())
+            pevent.fp1_y = RelativeTime(event.focalPlane.anodeF[0], event.focalPlane.scintR[0]);
+        if(!event.focalPlane.anodeB.empty() && !event.focalPlane.scintR.empty())
+            pevent.fp2_y = RelativeTime(event.focalPlane.anodeB[0], event.focalPlane.scintR[0]);
     }
    
     ProcessedEvent SFPAnalyzer::GetProcessedEvent(CoincEvent& event)
@@ -12,6 +12,7 @@
 
 #include "DataStructs.h"
 #include "FP_kinematics.h"
+#include "HistogramRegistry.h"
 
 namespace EventBuilder {
 
@@ -22,25 +23,23 @@ namespace EventBuilder {
 		            double b);
 		~SFPAnalyzer();
 		ProcessedEvent GetProcessedEvent(CoincEvent& event);
-		inline void ClearHashTable() { rootObj->Clear(); }
-		inline THashTable* GetHashTable() { return rootObj; }
+		inline HistogramRegistry& GetHistograms() { return m_histograms; }
 	
 	private:
 		void Reset(); //Sets ouput structure back to "zero"
 		void GetWeights(); //weights for xavg
 		void AnalyzeEvent(CoincEvent& event);
-	
-		/*Fill wrappers for use with THashTable*/
-		void MyFill(const std::string& name, int binsx, double minx, double maxx, double valuex,
-					int binsy, double miny, double maxy, double valuey);
-		void MyFill(const std::string& name, int binsx, double minx, double maxx, double valuex);
+		void BookHistograms();
 	
 		CoincEvent *event_address; //Input branch address
 		ProcessedEvent pevent, blank; //output branch and reset
 	
 		double w1, w2, zfp;
 	
-		THashTable *rootObj; //root storage
+		HistogramRegistry m_histograms;
+		HistogramRegistry::Handle1D h_x1, h_x2, h_xavg;
+		HistogramRegistry::Handle1D h_cebraE[5];
+		HistogramRegistry::Handle2D h_x1_anodeBack, h_x2_anodeBack, h_anodeBack_scintLeft, h_xavg_theta, h_x1_x2;
 	};
 
 }
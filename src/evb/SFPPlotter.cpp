@@ -9,53 +9,203 @@
 #include "EventBuilder.h"
 #include "SFPPlotter.h"
 #include <TSystem.h>
-#include <TRandom.h>
+#include <future>
+#include <atomic>
 
 namespace EventBuilder {
 
 	/*Generates storage and initializes pointers*/
 	SFPPlotter::SFPPlotter() :
-		event_address(new ProcessedEvent()), m_progressFraction(0.1)
+		m_nThreads(1), m_progressFraction(0.1)
 	{
 	}
 	
 	SFPPlotter::~SFPPlotter() 
 	{
-		delete event_address;
 	}
 	
-	/*2D histogram fill wrapper*/
-	void SFPPlotter::MyFill(THashTable* table, const std::string& name, int binsx, double minx, double maxx, double valuex,
-							int binsy, double miny, double maxy, double valuey)
+	/*
+		Books every histogram of MakeUncutHistograms and MakeCutHistograms, so that filling them is through handles only.
+		With a histogram spec, only the histograms of the spec are booked.
+	*/
+	void SFPPlotter::BookHistograms(HistogramRegistry& hists)
 	{
-		TH2F *histo = (TH2F*) table->FindObject(name.c_str());
-		if(histo != nullptr) 
-			histo->Fill(valuex, valuey);
-		else
+		if(m_spec.IsValid())
 		{
-			TH2F *h = new TH2F(name.c_str(), name.c_str(), binsx, minx, maxx, binsy, miny, maxy);
-			h->Fill(valuex, valuey);
-			table->Add(h);
+			m_spec.Book(hists);
+			return;
 		}
-	}
-	
-	/*1D histogram fill wrapper*/
-	void SFPPlotter::MyFill(THashTable* table, const std::string& name, int binsx, double minx, double maxx, double valuex)
-	{
-		TH1F *histo = (TH1F*) table->FindObject(name.c_str());
-		if(histo != nullptr)
-			histo->Fill(valuex);
-		else 
+
+		m_uncut.x1NoCuts_bothplanes = hists.Book("x1NoCuts_bothplanes", 600, -300, 300);
+		m_uncut.x2NoCuts_bothplanes = hists.Book("x2NoCuts_bothplanes", 600, -300, 300);
+		m_uncut.xavgNoCuts_bothplanes = hists.Book("xavgNoCuts_bothplanes", 600, -300, 300);
+		m_uncut.xavgNoCuts_theta_bothplanes = hists.Book("xavgNoCuts_theta_bothplanes", 600, -300, 300, 100, 0, TMath::Pi()/2.);
+		m_uncut.x1_delayBackRightE_NoCuts = hists.Book("x1_delayBackRightE_NoCuts", 600, -300, 300, 512, 0, 4096);
+		m_uncut.x2_delayBackRightE_NoCuts = hists.Book("x2_delayBackRightE_NoCuts", 600, -300, 300, 512, 0, 4096);
+		m_uncut.x1_delayBackLeftE_NoCuts = hists.Book("x1_delayBackLeftE_NoCuts", 600, -300, 300, 512, 0, 4096);
+		m_uncut.x2_delayBackLeftE_NoCuts = hists.Book("x2_delayBackLeftE_NoCuts", 600, -300, 300, 512, 0, 4096);
+		m_uncut.xavg_delayBackRightE_NoCuts = hists.Book("xavg_delayBackRightE_NoCuts", 600, -300, 300, 512, 0, 4096);
+		m_uncut.xavg_delayBackLeftE_NoCuts = hists.Book("xavg_delayBackLeftE_NoCuts", 600, -300, 300, 512, 0, 4096);
+		m_uncut.x1_x2_NoCuts = hists.Book("x1_x2_NoCuts", 600, -300, 300, 600, -300, 300);
+		m_uncut.x1_delayBackAvgE_NoCuts = hists.Book("x1_delayBackAvgE_NoCuts", 600, -300, 300, 512, 0, 4096);
+		m_uncut.x2_delayBackAvgE_NoCuts = hists.Book("x2_delayBackAvgE_NoCuts", 600, -300, 300, 512, 0, 4096);
+		m_uncut.xavg_delayBackAvgE_NoCuts = hists.Book("xavg_delayBackAvgE_NoCuts", 600, -300, 300, 512, 0, 4096);
+		m_uncut.x1_delayFrontAvgE_NoCuts = hists.Book("x1_delayFrontAvgE_NoCuts", 600, -300, 300, 512, 0, 4096);
+		m_uncut.x2_delayFrontAvgE_NoCuts = hists.Book("x2_delayFrontAvgE_NoCuts", 600, -300, 300, 512, 0, 4096);
+		m_uncut.xavg_delayFrontAvgE_NoCuts = hists.Book("xavg_delayFrontAvgE_NoCuts", 600, -300, 300, 512, 0, 4096);
+		m_uncut.scintLeft_anodeBack_NoCuts = hists.Book("scintLeft_anodeBack_NoCuts", 512, 0, 4096, 512, 0, 4096);
+		m_uncut.scintLeft_anodeFront_NoCuts = hists.Book("scintLeft_anodeFront_NoCuts", 512, 0, 4096, 512, 0, 4096);
+		m_uncut.scintLeft_cathode_NoCuts = hists.Book("scintLeft_cathode_NoCuts", 512, 0, 4096, 512, 0, 4096);
+		m_uncut.scintRight_anodeBack_NoCuts = hists.Book("scintRight_anodeBack_NoCuts", 512, 0, 4096, 512, 0, 4096);
+		m_uncut.scintRight_anodeFront_NoCuts = hists.Book("scintRight_anodeFront_NoCuts", 512, 0, 4096, 512, 0, 4096);
+		m_uncut.scintRight_cathode_NoCuts = hists.Book("scintRight_cathode_NoCuts", 512, 0, 4096, 512, 0, 4096);
+		m_uncut.x1_scintLeft_NoCuts = hists.Book("x1_scintLeft_NoCuts", 600, -300, 300, 512, 0, 4096);
+		m_uncut.x2_scintLeft_NoCuts = hists.Book("x2_scintLeft_NoCuts", 600, -300, 300, 512, 0, 4096);
+		m_uncut.xavg_scintLeft_NoCuts = hists.Book("xavg_scintLeft_NoCuts", 600, -300, 300, 512, 0, 4096);
+		m_uncut.xavg_scintRight_NoCuts = hists.Book("xavg_scintRight_NoCuts", 600, -300, 300, 512, 0, 4096);
+		m_uncut.x1_anodeBack_NoCuts = hists.Book("x1_anodeBack_NoCuts", 600, -300, 300, 512, 0, 4096);
+		m_uncut.x2_anodeBack_NoCuts = hists.Book("x2_anodeBack_NoCuts", 600, -300, 300, 512, 0, 4096);
+		m_uncut.xavg_anodeBack_NoCuts = hists.Book("xavg_anodeBack_NoCuts", 600, -300, 300, 512, 0, 4096);
+		m_uncut.x1_anodeFront_NoCuts = hists.Book("x1_anodeFront_NoCuts", 600, -300, 300, 512, 0, 4096);
+		m_uncut.x2_anodeFront_NoCuts = hists.Book("x2_anodeFront_NoCuts", 600, -300, 300, 512, 0, 4096);
+		m_uncut.xavg_anodeFront_NoCuts = hists.Book("xavg_anodeFront_NoCuts", 600, -300, 300, 512, 0, 4096);
+		m_uncut.x1_cathode_NoCuts = hists.Book("x1_cathode_NoCuts", 600, -300, 300, 512, 0, 4096);
+		m_uncut.x2_cathode_NoCuts = hists.Book("x2_cathode_NoCuts", 600, -300, 300, 512, 0, 4096);
+		m_uncut.xavg_cathode_NoCuts = hists.Book("xavg_cathode_NoCuts", 600, -300, 300, 512, 0, 4096);
+		m_uncut.x1_delayFrontRightE_noCuts = hists.Book("x1_delayFrontRightE_noCuts", 600, -300, 300, 512, 0, 4096);
+		m_uncut.x2_delayFrontRightE_noCuts = hists.Book("x2_delayFrontRightE_noCuts", 600, -300, 300, 512, 0, 4096);
+		m_uncut.x1_delayFrontLeftE_noCuts = hists.Book("x1_delayFrontLeftE_noCuts", 600, -300, 300, 512, 0, 4096);
+		m_uncut.x2_delayFrontLeftE_noCuts = hists.Book("x2_delayFrontLeftE_noCuts", 600, -300, 300, 512, 0, 4096);
+		m_uncut.xavg_delayFrontRightE_noCuts = hists.Book("xavg_delayFrontRightE_noCuts", 600, -300, 300, 512, 0, 4096);
+		m_uncut.xavg_delayFrontLeftE_noCuts = hists.Book("xavg_delayFrontLeftE_noCuts", 600, -300, 300, 512, 0, 4096);
+		m_uncut.anodeRelFrontTime_NoCuts = hists.Book("anodeRelFrontTime_NoCuts", 1000, -3000, 3500);
+		m_uncut.delayRelFrontTime_NoCuts = hists.Book("delayRelFrontTime_NoCuts", 1000, -3000, -3500);
+		m_uncut.delayRelBackTime_NoCuts = hists.Book("delayRelBackTime_NoCuts", 1000, -3000, -3500);
+		m_uncut.delayFL_RelScint_NoCuts = hists.Book("delayFL_RelScint_NoCuts", 3000, -3000, 3000);
+		m_uncut.delayFR_RelScint_NoCuts = hists.Book("delayFR_RelScint_NoCuts", 3000, -3000, 3000);
+		m_uncut.delayBL_RelScint_NoCuts = hists.Book("delayBL_RelScint_NoCuts", 3000, -3000, 3000);
+		m_uncut.delayBR_RelScint_NoCuts = hists.Book("delayBR_RelScint_NoCuts", 3000, -3000, 3000);
+		m_uncut.anodeBackRelTime_toScint = hists.Book("anodeBackRelTime_toScint", 1000, -3000, 3500);
+		m_uncut.delayRelBackTime_toScint = hists.Book("delayRelBackTime_toScint", 1000, -3000, 3500);
+		m_uncut.delayRelFrontTime_toScint = hists.Book("delayRelFrontTime_toScint", 1000, -3000, 3500);
+		m_uncut.noscinttime_counter_NoCuts = hists.Book("noscinttime_counter_NoCuts", 2, 0, 1);
+		m_uncut.cebra_E_ADCShift_noCuts = hists.Book("cebra_E_ADCShift_noCuts", 1024, 0, 4096);
+		m_uncut.x1NoCuts_only1plane = hists.Book("x1NoCuts_only1plane", 600, -300, 300);
+		m_uncut.x2NoCuts_only1plane = hists.Book("x2NoCuts_only1plane", 600, -300, 300);
+		m_uncut.nopos_counter = hists.Book("nopos_counter", 2, 0, 1);
+		for(int i=0; i<5; i++)
 		{
-			TH1F *h = new TH1F(name.c_str(), name.c_str(), binsx, minx, maxx);
-			h->Fill(valuex);
-			table->Add(h);
+			m_uncut.cebra_RelTime_toScint_N_noCuts[i] = hists.Book(fmt::format("cebra_RelTime_toScint_{}_noCuts", i), 12000, -6000, 6000);
+			m_uncut.cebra_E_N_noCuts[i] = hists.Book(fmt::format("cebra_E_{}_noCuts", i), 1024, 0, 4096);
+			m_uncut.cebra_E_N_cebraTime_noCuts[i] = hists.Book(fmt::format("cebra_E_{}_cebraTime_noCuts", i), 7200, 0, 7200, 1024, 0, 4096);
+			m_uncut.cebra_E_N_ADCShift_noCuts[i] = hists.Book(fmt::format("cebra_E_{}_ADCShift_noCuts", i), 1024, 0, 4096);
+			m_uncut.cebra_E_N_ADCShift_cebraTime_noCuts[i] = hists.Book(fmt::format("cebra_E_{}_ADCShift_cebraTime_noCuts", i), 7200, 0, 7200, 1024, 0, 4096);
+		}
+
+		m_cut.x1_bothplanes_Cut = hists.Book("x1_bothplanes_Cut", 600, -300, 300);
+		m_cut.x2_bothplanes_Cut = hists.Book("x2_bothplanes_Cut", 600, -300, 300);
+		m_cut.RelDelayFrontLeftTime_rel_to_frontanode_Cut = hists.Book("RelDelayFrontLeftTime_rel_to_frontanode_Cut", 8000, -4000, 4000);
+		m_cut.RelDelayFrontRightTime_rel_to_frontanode_Cut = hists.Book("RelDelayFrontRightTime_rel_to_frontanode_Cut", 8000, -4000, 4000);
+		m_cut.RelDelayBackLeftTime_rel_to_backanode_Cut = hists.Book("RelDelayBackLeftTime_rel_to_backanode_Cut", 8000, -4000, 4000);
+		m_cut.RelDelayBackRightTime_rel_to_backanode_Cut = hists.Book("RelDelayBackRightTime_rel_to_backanode_Cut", 8000, -4000, 4000);
+		m_cut.xavg_bothplanes_Cut = hists.Book("xavg_bothplanes_Cut", 600, -300, 300);
+		m_cut.x1_x2_Cut = hists.Book("x1_x2_Cut", 600, -300, 300, 600, -300, 300);
+		m_cut.xavg_theta_Cut_bothplanes = hists.Book("xavg_theta_Cut_bothplanes", 600, -300, 300, 100, 0, TMath::Pi()/2.);
+		m_cut.x1_only1plane_Cut = hists.Book("x1_only1plane_Cut", 600, -300, 300);
+		m_cut.RelDelayFrontLeftTime_nox2_rel_to_frontanode_Cut = hists.Book("RelDelayFrontLeftTime_nox2_rel_to_frontanode_Cut", 8000, -4000, 4000);
+		m_cut.RelDelayFrontRightTime_nox2_rel_to_frontanode_Cut = hists.Book("RelDelayFrontRightTime_nox2_rel_to_frontanode_Cut", 8000, -4000, 4000);
+		m_cut.RelDelayBackLeftTime_nox2_rel_to_frontanode_Cut = hists.Book("RelDelayBackLeftTime_nox2_rel_to_frontanode_Cut", 8000, -4000, 4000);
+		m_cut.RelDelayBackRightTime_nox2_rel_to_frontanode_Cut = hists.Book("RelDelayBackRightTime_nox2_rel_to_frontanode_Cut", 8000, -4000, 4000);
+		m_cut.RelDelayFrontLeftTime_nox2_rel_to_backanode_Cut = hists.Book("RelDelayFrontLeftTime_nox2_rel_to_backanode_Cut", 8000, -4000, 4000);
+		m_cut.RelDelayFrontRightTime_nox2_rel_to_backanode_Cut = hists.Book("RelDelayFrontRightTime_nox2_rel_to_backanode_Cut", 8000, -4000, 4000);
+		m_cut.RelDelayBackLeftTime_nox2_rel_to_backanode_Cut = hists.Book("RelDelayBackLeftTime_nox2_rel_to_backanode_Cut", 8000, -4000, 4000);
+		m_cut.RelDelayBackRightTime_nox2_rel_to_backanode_Cut = hists.Book("RelDelayBackRightTime_nox2_rel_to_backanode_Cut", 8000, -4000, 4000);
+		m_cut.x2_only1plane_Cut = hists.Book("x2_only1plane_Cut", 600, -300, 300);
+		m_cut.RelDelayFrontLeftTime_nox1_rel_to_frontanode_Cut = hists.Book("RelDelayFrontLeftTime_nox1_rel_to_frontanode_Cut", 8000, -4000, 4000);
+		m_cut.RelDelayFrontRightTime_nox1_rel_to_frontanode_Cut = hists.Book("RelDelayFrontRightTime_nox1_rel_to_frontanode_Cut", 8000, -4000, 4000);
+		m_cut.RelDelayBackLeftTime_nox1_rel_to_frontanode_Cut = hists.Book("RelDelayBackLeftTime_nox1_rel_to_frontanode_Cut", 8000, -4000, 4000);
+		m_cut.RelDelayBackRightTime_nox1_rel_to_frontanode_Cut = hists.Book("RelDelayBackRightTime_nox1_rel_to_frontanode_Cut", 8000, -4000, 4000);
+		m_cut.RelDelayFrontLeftTime_nox1_rel_to_backanode_Cut = hists.Book("RelDelayFrontLeftTime_nox1_rel_to_backanode_Cut", 8000, -4000, 4000);
+		m_cut.RelDelayFrontRightTime_nox1_rel_to_backanode_Cut = hists.Book("RelDelayFrontRightTime_nox1_rel_to_backanode_Cut", 8000, -4000, 4000);
+		m_cut.RelDelayBackLeftTime_nox1_rel_to_backanode_Cut = hists.Book("RelDelayBackLeftTime_nox1_rel_to_backanode_Cut", 8000, -4000, 4000);
+		m_cut.RelDelayBackRightTime_nox1_rel_to_backanode_Cut = hists.Book("RelDelayBackRightTime_nox1_rel_to_backanode_Cut", 8000, -4000, 4000);
+		m_cut.x1_delayBackRightE_Cut = hists.Book("x1_delayBackRightE_Cut", 600, -300, 300, 512, 0, 4096);
+		m_cut.x2_delayBackRightE_Cut = hists.Book("x2_delayBackRightE_Cut", 600, -300, 300, 512, 0, 4096);
+		m_cut.x1_delayBackLeftE_Cut = hists.Book("x1_delayBackLeftE_Cut", 600, -300, 300, 512, 0, 4096);
+		m_cut.x2_delayBackLeftE_Cut = hists.Book("x2_delayBackLeftE_Cut", 600, -300, 300, 512, 0, 4096);
+		m_cut.xavg_delayBackRightE_Cut = hists.Book("xavg_delayBackRightE_Cut", 600, -300, 300, 512, 0, 4096);
+		m_cut.xavg_delayBackLeftE_Cut = hists.Book("xavg_delayBackLeftE_Cut", 600, -300, 300, 512, 0, 4096);
+		m_cut.x1_delayFrontRightE_Cut = hists.Book("x1_delayFrontRightE_Cut", 600, -300, 300, 512, 0, 4096);
+		m_cut.x2_delayFrontRightE_Cut = hists.Book("x2_delayFrontRightE_Cut", 600, -300, 300, 512, 0, 4096);
+		m_cut.x1_delayFrontLeftE_Cut = hists.Book("x1_delayFrontLeftE_Cut", 600, -300, 300, 512, 0, 4096);
+		m_cut.x2_delayFrontLeftE_Cut = hists.Book("x2_delayFrontLeftE_Cut", 600, -300, 300, 512, 0, 4096);
+		m_cut.xavg_delayFrontRightE_Cut = hists.Book("xavg_delayFrontRightE_Cut", 600, -300, 300, 512, 0, 4096);
+		m_cut.xavg_delayFrontLeftE_Cut = hists.Book("xavg_delayFrontLeftE_Cut", 600, -300, 300, 512, 0, 4096);
+		m_cut.x1_delayBackAvgE_Cut = hists.Book("x1_delayBackAvgE_Cut", 600, -300, 300, 512, 0, 4096);
+		m_cut.x2_delayBackAvgE_Cut = hists.Book("x2_delayBackAvgE_Cut", 600, -300, 300, 512, 0, 4096);
+		m_cut.xavg_delayBackAvgE_Cut = hists.Book("xavg_delayBackAvgE_Cut", 600, -300, 300, 512, 0, 4096);
+		m_cut.x1_delayFrontAvgE_Cut = hists.Book("x1_delayFrontAvgE_Cut", 600, -300, 300, 512, 0, 4096);
+		m_cut.x2_delayFrontAvgE_Cut = hists.Book("x2_delayFrontAvgE_Cut", 600, -300, 300, 512, 0, 4096);
+		m_cut.xavg_delayFrontAvgE_Cut = hists.Book("xavg_delayFrontAvgE_Cut", 600, -300, 300, 512, 0, 4096);
+		m_cut.scintLeft_anodeBack_Cut = hists.Book("scintLeft_anodeBack_Cut", 512, 0, 4096, 512, 0, 4096);
+		m_cut.scintLeft_anodeFront_Cut = hists.Book("scintLeft_anodeFront_Cut", 512, 0, 4096, 512, 0, 4096);
+		m_cut.scintLeft_cathode_Cut = hists.Book("scintLeft_cathode_Cut", 512, 0, 4096, 512, 0, 4096);
+		m_cut.scintRight_anodeBack_Cut = hists.Book("scintRight_anodeBack_Cut", 512, 0, 4096, 512, 0, 4096);
+		m_cut.scintRight_anodeFront_Cut = hists.Book("scintRight_anodeFront_Cut", 512, 0, 4096, 512, 0, 4096);
+		m_cut.scintRight_cathode_Cut = hists.Book("scintRight_cathode_Cut", 512, 0, 4096, 512, 0, 4096);
+		m_cut.x1_scintLeft_Cut = hists.Book("x1_scintLeft_Cut", 600, -300, 300, 512, 0, 4096);
+		m_cut.x2_scintLeft_Cut = hists.Book("x2_scintLeft_Cut", 600, -300, 300, 512, 0, 4096);
+		m_cut.xavg_scintLeft_Cut = hists.Book("xavg_scintLeft_Cut", 600, -300, 300, 512, 0, 4096);
+		m_cut.xavg_scintRight_Cut = hists.Book("xavg_scintRight_Cut", 600, -300, 300, 512, 0, 4096);
+		m_cut.x1_anodeBack_Cut = hists.Book("x1_anodeBack_Cut", 600, -300, 300, 512, 0, 4096);
+		m_cut.x2_anodeBack_Cut = hists.Book("x2_anodeBack_Cut", 600, -300, 300, 512, 0, 4096);
+		m_cut.xavg_anodeBack_Cut = hists.Book("xavg_anodeBack_Cut", 600, -300, 300, 512, 0, 4096);
+		m_cut.x1_anodeFront_Cut = hists.Book("x1_anodeFront_Cut", 600, -300, 300, 512, 0, 4096);
+		m_cut.x2_anodeFront_Cut = hists.Book("x2_anodeFront_Cut", 600, -300, 300, 512, 0, 4096);
+		m_cut.xavg_anodeFront_Cut = hists.Book("xavg_anodeFront_Cut", 600, -300, 300, 512, 0, 4096);
+		m_cut.x1_cathode_Cut = hists.Book("x1_cathode_Cut", 600, -300, 300, 512, 0, 4096);
+		m_cut.x2_cathode_Cut = hists.Book("x2_cathode_Cut", 600, -300, 300, 512, 0, 4096);
+		m_cut.xavg_cathode_Cut = hists.Book("xavg_cathode_Cut", 600, -300, 300, 512, 0, 4096);
+		m_cut.anodeRelBackTime_Cut = hists.Book("anodeRelBackTime_Cut", 1000, -3000, 3500);
+		m_cut.anodeRelFrontTime_Cut = hists.Book("anodeRelFrontTime_Cut", 1000, -3000, 3500);
+		m_cut.anodeRelTime_toScint_Cut = hists.Book("anodeRelTime_toScint_Cut", 1000, -3000, 3500);
+		m_cut.delayFL_RelScint_Cuts = hists.Book("delayFL_RelScint_Cuts", 3000, -3000, 3000);
+		m_cut.delayFR_RelScint_Cuts = hists.Book("delayFR_RelScint_Cuts", 3000, -3000, 3000);
+		m_cut.delayBL_RelScint_Cuts = hists.Book("delayBL_RelScint_Cuts", 3000, -3000, 3000);
+		m_cut.delayBR_RelScint_Cuts = hists.Book("delayBR_RelScint_Cuts", 3000, -3000, 3000);
+		m_cut.xavg_timeDifferenceScints = hists.Book("xavg_timeDifferenceScints", 600, -300, 300, 12800, -3200, 3200);
+		m_cut.xavg_TimeCutShift_Cut = hists.Book("xavg_TimeCutShift_Cut", 600, -300, 300);
+		m_cut.AA_xavg_cebraE_Sum_TimeCutShift_Cut = hists.Book("AA_xavg_cebraE_Sum_TimeCutShift_Cut", 600, -300, 300, 512, 0, 4096);
+		m_cut.AA_x1_cebraE_Sum_TimeCutShift_Cut = hists.Book("AA_x1_cebraE_Sum_TimeCutShift_Cut", 600, -300, 300, 512, 0, 4096);
+		m_cut.AA_xavg_cebraE_Sum_EnergyCalibrated_TimeCutShift_Cut = hists.Book("AA_xavg_cebraE_Sum_EnergyCalibrated_TimeCutShift_Cut", 600, -300, 300, 2048, 0, 8192);
+		m_cut.AA_x1_cebraE_Sum_EnergyCalibrated_TimeCutShift_Cut = hists.Book("AA_x1_cebraE_Sum_EnergyCalibrated_TimeCutShift_Cut", 600, -300, 300, 2048, 0, 8192);
+		m_cut.AA_ENERGYCAL_xavg_cebraE_TimeCutShift_Cut = hists.Book("AA_ENERGYCAL_xavg_cebraE_TimeCutShift_Cut", 1024, 0, 8192, 2048, 0, 8192);
+		m_cut.AA_ENERGYCAL_xavg_TimeCutShift_Cut = hists.Book("AA_ENERGYCAL_xavg_TimeCutShift_Cut", 2048, 0, 8192);
+		m_cut.AA_cebraE_Sum_ADCShift_TimeCutShift_Cut = hists.Book("AA_cebraE_Sum_ADCShift_TimeCutShift_Cut", 1024, 0, 4096);
+		m_cut.AA_cebraE_Sum_EnergyCal_TimeCutShift_Cut = hists.Book("AA_cebraE_Sum_EnergyCal_TimeCutShift_Cut", 2048, 0, 8192);
+		m_cut.xavg_cebraE_zony_TimeCutShift_Cut = hists.Book("xavg_cebraE_zony_TimeCutShift_Cut", 600, -300, 300, 512, 0, 4096);
+		m_cut.x1_cebraE_zony_TimeCutShift_Cut = hists.Book("x1_cebraE_zony_TimeCutShift_Cut", 600, -300, 300, 512, 0, 4096);
+		m_cut.cebra_E_ADCShift_Cut = hists.Book("cebra_E_ADCShift_Cut", 1024, 0, 4096);
+		m_cut.AA_xavg_cebraE_Sum_Cut = hists.Book("AA_xavg_cebraE_Sum_Cut", 600, -300, 300, 512, 0, 4096);
+		for(int i=0; i<5; i++)
+		{
+			m_cut.cebra_RelTime_toScint_N_Cut[i] = hists.Book(fmt::format("cebra_RelTime_toScint_{}_Cut", i), 6400, -3200, 3200);
+			m_cut.cebra_RelTime_toScint_N_theta_Cut[i] = hists.Book(fmt::format("cebra_RelTime_toScint_{}_theta_Cut", i), 6400, -3200, 3200, 100, 0, TMath::Pi()/2.);
+			m_cut.xavg_vs_timeDiff_cebraN_scintRight[i] = hists.Book(fmt::format("xavg_vs_timeDiff_cebra{}_scintRight", i), 600, -300, 300, 6400, -3200, 3200);
+			m_cut.xavg_vs_timeDiff_cebraN_scintLeft[i] = hists.Book(fmt::format("xavg_vs_timeDiff_cebra{}_scintLeft", i), 600, -300, 300, 6400, -3200, 3200);
+			m_cut.cebra_E_N_TimeCutShift_Cut[i] = hists.Book(fmt::format("cebra_E_{}_TimeCutShift_Cut", i), 512, 0, 4096);
+			m_cut.xavg_cebraE_N_TimeCutShift_Cut[i] = hists.Book(fmt::format("xavg_cebraE_{}_TimeCutShift_Cut", i), 600, -300, 300, 512, 0, 4096);
+			m_cut.x1_cebraE_N_TimeCutShift_Cut[i] = hists.Book(fmt::format("x1_cebraE_{}_TimeCutShift_Cut", i), 600, -300, 300, 512, 0, 4096);
+			m_cut.cebra_RelTime_toScint_N_TimeCutShift_Cut[i] = hists.Book(fmt::format("cebra_RelTime_toScint_{}_TimeCutShift_Cut", i), 400, -100, 100);
+			m_cut.cebra_E_N_Cut[i] = hists.Book(fmt::format("cebra_E_{}_Cut", i), 1024, 0, 4096);
+			m_cut.cebra_E_N_ADCShift_Cut[i] = hists.Book(fmt::format("cebra_E_{}_ADCShift_Cut", i), 1024, 0, 4096);
 		}
 	}
 	
 	/*Makes histograms where only rejection is unset data*/
-        void SFPPlotter::MakeUncutHistograms(const ProcessedEvent& ev, THashTable* table, int runNum)
+        void SFPPlotter::MakeUncutHistograms(const ProcessedEvent& ev, PlotWorker& worker, int runNum)
 	{
+		HistogramRegistry& hists = worker.hists;
 
 
 
@@ -90,60 +240,60 @@ namespace EventBuilder {
 
 
 		if(ev.x1 != -1e6 && ev.x2 != -1e6){
-		MyFill(table,"x1NoCuts_bothplanes",600,-300,300,ev.x1);
-		MyFill(table,"x2NoCuts_bothplanes",600,-300,300,ev.x2);
-		MyFill(table,"xavgNoCuts_bothplanes",600,-300,300,ev.xavg);
-		MyFill(table,"xavgNoCuts_theta_bothplanes",600,-300,300,ev.xavg,100,0,TMath::Pi()/2.,ev.theta);
+		hists.Fill(m_uncut.x1NoCuts_bothplanes, ev.x1);
+		hists.Fill(m_uncut.x2NoCuts_bothplanes, ev.x2);
+		hists.Fill(m_uncut.xavgNoCuts_bothplanes, ev.xavg);
+		hists.Fill(m_uncut.xavgNoCuts_theta_bothplanes, ev.xavg, ev.theta);
 		}
 		
-		MyFill(table,"x1_delayBackRightE_NoCuts",600,-300,300,ev.x1,512,0,4096,ev.delayBackRightE);
-		MyFill(table,"x2_delayBackRightE_NoCuts",600,-300,300,ev.x2,512,0,4096,ev.delayBackRightE);
-		MyFill(table,"x1_delayBackLeftE_NoCuts",600,-300,300,ev.x1,512,0,4096,ev.delayBackLeftE);
-		MyFill(table,"x2_delayBackLeftE_NoCuts",600,-300,300,ev.x2,512,0,4096,ev.delayBackLeftE);
-		MyFill(table,"xavg_delayBackRightE_NoCuts",600,-300,300,ev.xavg,512,0,4096,ev.delayBackRightE);
-		MyFill(table,"xavg_delayBackLeftE_NoCuts",600,-300,300,ev.xavg,512,0,4096,ev.delayBackLeftE);
-		MyFill(table,"x1_x2_NoCuts",600,-300,300,ev.x1,600,-300,300,ev.x2);
+		hists.Fill(m_uncut.x1_delayBackRightE_NoCuts, ev.x1, ev.delayBackRightE);
+		hists.Fill(m_uncut.x2_delayBackRightE_NoCuts, ev.x2, ev.delayBackRightE);
+		hists.Fill(m_uncut.x1_delayBackLeftE_NoCuts, ev.x1, ev.delayBackLeftE);
+		hists.Fill(m_uncut.x2_delayBackLeftE_NoCuts, ev.x2, ev.delayBackLeftE);
+		hists.Fill(m_uncut.xavg_delayBackRightE_NoCuts, ev.xavg, ev.delayBackRightE);
+		hists.Fill(m_uncut.xavg_delayBackLeftE_NoCuts, ev.xavg, ev.delayBackLeftE);
+		hists.Fill(m_uncut.x1_x2_NoCuts, ev.x1, ev.x2);
 	
 		Double_t delayBackAvgE = (ev.delayBackRightE+ev.delayBackLeftE)/2.0;
-		MyFill(table,"x1_delayBackAvgE_NoCuts",600,-300,300,ev.x1,512,0,4096,delayBackAvgE);
-		MyFill(table,"x2_delayBackAvgE_NoCuts",600,-300,300,ev.x2,512,0,4096,delayBackAvgE);
-		MyFill(table,"xavg_delayBackAvgE_NoCuts",600,-300,300,ev.xavg,512,0,4096,delayBackAvgE);
+		hists.Fill(m_uncut.x1_delayBackAvgE_NoCuts, ev.x1, delayBackAvgE);
+		hists.Fill(m_uncut.x2_delayBackAvgE_NoCuts, ev.x2, delayBackAvgE);
+		hists.Fill(m_uncut.xavg_delayBackAvgE_NoCuts, ev.xavg, delayBackAvgE);
 		Double_t delayFrontAvgE = (ev.delayFrontRightE+ev.delayFrontLeftE)/2.0;
-		MyFill(table,"x1_delayFrontAvgE_NoCuts",600,-300,300,ev.x1,512,0,4096,delayFrontAvgE);
-		MyFill(table,"x2_delayFrontAvgE_NoCuts",600,-300,300,ev.x2,512,0,4096,delayFrontAvgE);
-		MyFill(table,"xavg_delayFrontAvgE_NoCuts",600,-300,300,ev.xavg,512,0,4096,delayFrontAvgE);
+		hists.Fill(m_uncut.x1_delayFrontAvgE_NoCuts, ev.x1, delayFrontAvgE);
+		hists.Fill(m_uncut.x2_delayFrontAvgE_NoCuts, ev.x2, delayFrontAvgE);
+		hists.Fill(m_uncut.xavg_delayFrontAvgE_NoCuts, ev.xavg, delayFrontAvgE);
 	
-		MyFill(table,"scintLeft_anodeBack_NoCuts",512,0,4096,ev.scintLeft,512,0,4096,ev.anodeBack);
-		MyFill(table,"scintLeft_anodeFront_NoCuts",512,0,4096,ev.scintLeft,512,0,4096,ev.anodeFront);
-		MyFill(table,"scintLeft_cathode_NoCuts",512,0,4096,ev.scintLeft,512,0,4096,ev.cathode);
+		hists.Fill(m_uncut.scintLeft_anodeBack_NoCuts, ev.scintLeft, ev.anodeBack);
+		hists.Fill(m_uncut.scintLeft_anodeFront_NoCuts, ev.scintLeft, ev.anodeFront);
+		hists.Fill(m_uncut.scintLeft_cathode_NoCuts, ev.scintLeft, ev.cathode);
 
-		MyFill(table,"scintRight_anodeBack_NoCuts",512,0,4096,ev.scintRight,512,0,4096,ev.anodeBack);
-		MyFill(table,"scintRight_anodeFront_NoCuts",512,0,4096,ev.scintRight,512,0,4096,ev.anodeFront);
-		MyFill(table,"scintRight_cathode_NoCuts",512,0,4096,ev.scintRight,512,0,4096,ev.cathode);
+		hists.Fill(m_uncut.scintRight_anodeBack_NoCuts, ev.scintRight, ev.anodeBack);
+		hists.Fill(m_uncut.scintRight_anodeFront_NoCuts, ev.scintRight, ev.anodeFront);
+		hists.Fill(m_uncut.scintRight_cathode_NoCuts, ev.scintRight, ev.cathode);
 	
-		MyFill(table,"x1_scintLeft_NoCuts",600,-300,300,ev.x1,512,0,4096,ev.scintLeft);
-		MyFill(table,"x2_scintLeft_NoCuts",600,-300,300,ev.x2,512,0,4096,ev.scintLeft);
-		MyFill(table,"xavg_scintLeft_NoCuts",600,-300,300,ev.xavg,512,0,4096,ev.scintLeft);
-		MyFill(table,"xavg_scintRight_NoCuts",600,-300,300,ev.xavg,512,0,4096,ev.scintRight);
+		hists.Fill(m_uncut.x1_scintLeft_NoCuts, ev.x1, ev.scintLeft);
+		hists.Fill(m_uncut.x2_scintLeft_NoCuts, ev.x2, ev.scintLeft);
+		hists.Fill(m_uncut.xavg_scintLeft_NoCuts, ev.xavg, ev.scintLeft);
+		hists.Fill(m_uncut.xavg_scintRight_NoCuts, ev.xavg, ev.scintRight);
 	
-		MyFill(table,"x1_anodeBack_NoCuts",600,-300,300,ev.x1,512,0,4096,ev.anodeBack);
-		MyFill(table,"x2_anodeBack_NoCuts",600,-300,300,ev.x2,512,0,4096,ev.anodeBack);
-		MyFill(table,"xavg_anodeBack_NoCuts",600,-300,300,ev.xavg,512,0,4096,ev.anodeBack);
+		hists.Fill(m_uncut.x1_anodeBack_NoCuts, ev.x1, ev.anodeBack);
+		hists.Fill(m_uncut.x2_anodeBack_NoCuts, ev.x2, ev.anodeBack);
+		hists.Fill(m_uncut.xavg_anodeBack_NoCuts, ev.xavg, ev.anodeBack);
 	
-		MyFill(table,"x1_anodeFront_NoCuts",600,-300,300,ev.x1,512,0,4096,ev.anodeFront);
-		MyFill(table,"x2_anodeFront_NoCuts",600,-300,300,ev.x2,512,0,4096,ev.anodeFront);
-		MyFill(table,"xavg_anodeFront_NoCuts",600,-300,300,ev.xavg,512,0,4096,ev.anodeFront);
+		hists.Fill(m_uncut.x1_anodeFront_NoCuts, ev.x1, ev.anodeFront);
+		hists.Fill(m_uncut.x2_anodeFront_NoCuts, ev.x2, ev.anodeFront);
+		hists.Fill(m_uncut.xavg_anodeFront_NoCuts, ev.xavg, ev.anodeFront);
 	
-		MyFill(table,"x1_cathode_NoCuts",600,-300,300,ev.x1,512,0,4096,ev.cathode);
-		MyFill(table,"x2_cathode_NoCuts",600,-300,300,ev.x2,512,0,4096,ev.cathode);
-		MyFill(table,"xavg_cathode_NoCuts",600,-300,300,ev.xavg,512,0,4096,ev.cathode);
-
-		MyFill(table,"x1_delayFrontRightE_noCuts",600,-300,300,ev.x1,512,0,4096,ev.delayFrontRightE);
-		MyFill(table,"x2_delayFrontRightE_noCuts",600,-300,300,ev.x2,512,0,4096,ev.delayFrontRightE);
-		MyFill(table,"x1_delayFrontLeftE_noCuts",600,-300,300,ev.x1,512,0,4096,ev.delayFrontLeftE);
-		MyFill(table,"x2_delayFrontLeftE_noCuts",600,-300,300,ev.x2,512,0,4096,ev.delayFrontLeftE);
-		MyFill(table,"xavg_delayFrontRightE_noCuts",600,-300,300,ev.xavg,512,0,4096,ev.delayFrontRightE);
-		MyFill(table,"xavg_delayFrontLeftE_noCuts",600,-300,300,ev.xavg,512,0,4096,ev.delayFrontLeftE);
+		hists.Fill(m_uncut.x1_cathode_NoCuts, ev.x1, ev.cathode);
+		hists.Fill(m_uncut.x2_cathode_NoCuts, ev.x2, ev.cathode);
+		hists.Fill(m_uncut.xavg_cathode_NoCuts, ev.xavg, ev.cathode);
+
+		hists.Fill(m_uncut.x1_delayFrontRightE_noCuts, ev.x1, ev.delayFrontRightE);
+		hists.Fill(m_uncut.x2_delayFrontRightE_noCuts, ev.x2, ev.delayFrontRightE);
+		hists.Fill(m_uncut.x1_delayFrontLeftE_noCuts, ev.x1, ev.delayFrontLeftE);
+		hists.Fill(m_uncut.x2_delayFrontLeftE_noCuts, ev.x2, ev.delayFrontLeftE);
+		hists.Fill(m_uncut.xavg_delayFrontRightE_noCuts, ev.xavg, ev.delayFrontRightE);
+		hists.Fill(m_uncut.xavg_delayFrontLeftE_noCuts, ev.xavg, ev.delayFrontLeftE);
 	
 		
 
@@ -160,13 +310,13 @@ namespace EventBuilder {
 			Double_t delayFR_toScint = ev.delayFrontRightTime - ev.scintLeftTime;
 			Double_t delayBL_toScint = ev.delayBackLeftTime - ev.scintLeftTime;
 			Double_t delayBR_toScint = ev.delayBackRightTime - ev.scintLeftTime;
-			MyFill(table,"anodeRelFrontTime_NoCuts",1000,-3000,3500, anodeRelFT);
-			MyFill(table,"delayRelFrontTime_NoCuts",1000,-3000,-3500,delayRelFT);
-			MyFill(table,"delayRelBackTime_NoCuts",1000,-3000,-3500,delayRelBT);
-			MyFill(table,"delayFL_RelScint_NoCuts",3000,-3000,3000,delayFL_toScint);
-			MyFill(table,"delayFR_RelScint_NoCuts",3000,-3000,3000,delayFR_toScint);
-			MyFill(table,"delayBL_RelScint_NoCuts",3000,-3000,3000,delayBL_toScint);
-			MyFill(table,"delayBR_RelScint_NoCuts",3000,-3000,3000,delayBR_toScint);
+			hists.Fill(m_uncut.anodeRelFrontTime_NoCuts, anodeRelFT);
+			hists.Fill(m_uncut.delayRelFrontTime_NoCuts, delayRelFT);
+			hists.Fill(m_uncut.delayRelBackTime_NoCuts, delayRelBT);
+			hists.Fill(m_uncut.delayFL_RelScint_NoCuts, delayFL_toScint);
+			hists.Fill(m_uncut.delayFR_RelScint_NoCuts, delayFR_toScint);
+			hists.Fill(m_uncut.delayBL_RelScint_NoCuts, delayBL_toScint);
+			hists.Fill(m_uncut.delayBR_RelScint_NoCuts, delayBR_toScint);
 
 			
 			
@@ -174,15 +324,15 @@ namespace EventBuilder {
 
 				//Cebra Relative Time to Left Scint Plots
 				Double_t cebraRelT_toScint = ev.cebraTime[i] - ev.scintLeftTime;
-				MyFill(table,fmt::format("cebra_RelTime_toScint_{}_noCuts",i),12000,-6000,6000,cebraRelT_toScint);
+				hists.Fill(m_uncut.cebra_RelTime_toScint_N_noCuts[i], cebraRelT_toScint);
 				// MyFill(table,"cebra_RelTime_toScint_noCuts",8000,-4000,4000,cebraRelT_toScint);
 			}
 
-			MyFill(table,"anodeBackRelTime_toScint",1000,-3000,3500,anodeRelBT);
-			MyFill(table,"delayRelBackTime_toScint",1000,-3000,3500,delayRelBT_toScint);
-			MyFill(table,"delayRelFrontTime_toScint",1000,-3000,3500,delayRelFT_toScint);
+			hists.Fill(m_uncut.anodeBackRelTime_toScint, anodeRelBT);
+			hists.Fill(m_uncut.delayRelBackTime_toScint, delayRelBT_toScint);
+			hists.Fill(m_uncut.delayRelFrontTime_toScint, delayRelFT_toScint);
 		} else {
-		MyFill(table,"noscinttime_counter_NoCuts",2,0,1,1); 
+		hists.Fill(m_uncut.noscinttime_counter_NoCuts, 1);
 		}
 
 
@@ -191,8 +341,8 @@ namespace EventBuilder {
 		for(int i=0; i<5; i++) {
 			if(ev.cebraE[i] != -1){
 
-				MyFill(table,fmt::format("cebra_E_{}_noCuts",i),1024,0,4096,ev.cebraE[i]);
-				MyFill(table,fmt::format("cebra_E_{}_cebraTime_noCuts",i),7200, 0, 7200, ev.cebraTime[i] / 1e9, 1024,0,4096,ev.cebraE[i]);
+				hists.Fill(m_uncut.cebra_E_N_noCuts[i], ev.cebraE[i]);
+				hists.Fill(m_uncut.cebra_E_N_cebraTime_noCuts[i], ev.cebraTime[i] / 1e9, ev.cebraE[i]);
 
 				//Cebra ADC Channel shift (to make all the detectors line up with each other) with the corresponding plots
 				//good for run 82 - 123
@@ -226,7 +376,7 @@ namespace EventBuilder {
 				  }
 				  //   Apply the linear gain transformation.
 				  cebra_E_ADCShift[i] = gains.GetIntercept(runNum, rangeNum, i) + gains.GetSlope(runNum, rangeNum, i)*ev.cebraE[i];
-				  cebra_E_ADCShift[i] += gRandom->Rndm()-0.5; // To remove aliasing, assuming 12 bit ADC voltage resolution
+				  cebra_E_ADCShift[i] += worker.random.Rndm()-0.5; // To remove aliasing, assuming 12 bit ADC voltage resolution
 				  // std::cout << "det " << i 
 				  // 	    << ", b = " <<  gains.GetIntercept(runNum, rangeNum, i) 
 				  // 	    << ", m = " << gains.GetSlope(runNum, rangeNum, i)
@@ -237,10 +387,9 @@ namespace EventBuilder {
 				  cebra_E_ADCShift[i] = ev.cebraE[i];
 				}
 				
-				MyFill(table,fmt::format("cebra_E_{}_ADCShift_noCuts",i),1024,0,4096,cebra_E_ADCShift[i]);
-				MyFill(table,"cebra_E_ADCShift_noCuts",1024,0,4096,cebra_E_ADCShift[i]);
-				MyFill(table,fmt::format("cebra_E_{}_ADCShift_cebraTime_noCuts",i),7200, 0, 7200, ev.cebraTime[i] / 1e9, 1024,0,4096,
-				       cebra_E_ADCShift[i]);
+				hists.Fill(m_uncut.cebra_E_N_ADCShift_noCuts[i], cebra_E_ADCShift[i]);
+				hists.Fill(m_uncut.cebra_E_ADCShift_noCuts, cebra_E_ADCShift[i]);
+				hists.Fill(m_uncut.cebra_E_N_ADCShift_cebraTime_noCuts[i], ev.cebraTime[i] / 1e9, cebra_E_ADCShift[i]);
 				
 				// if(ev.x1 != -1e6 && ev.x2 != -1e6){
 				// MyFill(table,fmt::format("x1_cebraE_{}_noCuts",i),600,-300,300,ev.x1,1024,0,1024,ev.cebraE[i]);
@@ -251,119 +400,120 @@ namespace EventBuilder {
 		}	
 
 		if(ev.x1 != -1e6 && ev.x2 == -1e6)
-			MyFill(table,"x1NoCuts_only1plane",600,-300,300,ev.x1);
+			hists.Fill(m_uncut.x1NoCuts_only1plane, ev.x1);
 		else if(ev.x2 != -1e6 && ev.x1 == -1e6)
-			MyFill(table,"x2NoCuts_only1plane",600,-300,300,ev.x2);
+			hists.Fill(m_uncut.x2NoCuts_only1plane, ev.x2);
 		else if(ev.x1 == -1e6 && ev.x2 == -1e6)
-			MyFill(table,"nopos_counter",2,0,1,1);
+			hists.Fill(m_uncut.nopos_counter, 1);
 	}
 	
 	/*Makes histograms with cuts & gates implemented*/
-        void SFPPlotter::MakeCutHistograms(const ProcessedEvent& ev, THashTable* table, int runNum) 
+        void SFPPlotter::MakeCutHistograms(const ProcessedEvent& ev, PlotWorker& worker, int runNum) 
 	{
-		if(!cutter.IsInside(&ev)) 
+		if(!worker.cuts.IsInside(&ev)) 
 			return;
+		HistogramRegistry& hists = worker.hists;
 	
 
 		if(ev.x1 != -1e6 && ev.x2 != -1e6){
-		MyFill(table,"x1_bothplanes_Cut",600,-300,300,ev.x1);
-		MyFill(table,"x2_bothplanes_Cut",600,-300,300,ev.x2);
+		hists.Fill(m_cut.x1_bothplanes_Cut, ev.x1);
+		hists.Fill(m_cut.x2_bothplanes_Cut, ev.x2);
 
-		MyFill(table,"RelDelayFrontLeftTime_rel_to_frontanode_Cut",8000,-4000,4000,ev.delayFrontLeftTime-ev.anodeFrontTime);
-		MyFill(table,"RelDelayFrontRightTime_rel_to_frontanode_Cut",8000,-4000,4000,ev.delayFrontRightTime-ev.anodeFrontTime);
+		hists.Fill(m_cut.RelDelayFrontLeftTime_rel_to_frontanode_Cut, ev.delayFrontLeftTime-ev.anodeFrontTime);
+		hists.Fill(m_cut.RelDelayFrontRightTime_rel_to_frontanode_Cut, ev.delayFrontRightTime-ev.anodeFrontTime);
 		// MyFill(table,"RelDelayBackLeftTime_rel_to_frontanode_Cut",8000,-4000,4000,ev.delayBackLeftTime-ev.anodeFrontTime);
 		// MyFill(table,"RelDelayBackRightTime_rel_to_frontanode_Cut",8000,-4000,4000,ev.delayBackRightTime-ev.anodeFrontTime);
 
 		// MyFill(table,"RelDelayFrontLeftTime_rel_to_backanode_Cut",8000,-4000,4000,ev.delayFrontLeftTime-ev.anodeBackTime);
 		// MyFill(table,"RelDelayFrontRightTime_rel_to_backanode_Cut",8000,-4000,4000,ev.delayFrontRightTime-ev.anodeBackTime);
-		MyFill(table,"RelDelayBackLeftTime_rel_to_backanode_Cut",8000,-4000,4000,ev.delayBackLeftTime-ev.anodeBackTime);
-		MyFill(table,"RelDelayBackRightTime_rel_to_backanode_Cut",8000,-4000,4000,ev.delayBackRightTime-ev.anodeBackTime);
+		hists.Fill(m_cut.RelDelayBackLeftTime_rel_to_backanode_Cut, ev.delayBackLeftTime-ev.anodeBackTime);
+		hists.Fill(m_cut.RelDelayBackRightTime_rel_to_backanode_Cut, ev.delayBackRightTime-ev.anodeBackTime);
 
 
 
 		}
 
-		MyFill(table,"xavg_bothplanes_Cut",600,-300,300,ev.xavg);
-		MyFill(table,"x1_x2_Cut",600,-300,300,ev.x1, 600,-300,300,ev.x2);
-		MyFill(table,"xavg_theta_Cut_bothplanes",600,-300,300,ev.xavg,100,0,TMath::Pi()/2.,ev.theta);
+		hists.Fill(m_cut.xavg_bothplanes_Cut, ev.xavg);
+		hists.Fill(m_cut.x1_x2_Cut, ev.x1, ev.x2);
+		hists.Fill(m_cut.xavg_theta_Cut_bothplanes, ev.xavg, ev.theta);
 
 		if(ev.x1 != -1e6 && ev.x2 == -1e6){
-		MyFill(table, "x1_only1plane_Cut", 600, -300, 300, ev.x1);
+		hists.Fill(m_cut.x1_only1plane_Cut, ev.x1);
 
-		MyFill(table,"RelDelayFrontLeftTime_nox2_rel_to_frontanode_Cut",8000,-4000,4000,ev.delayFrontLeftTime-ev.anodeFrontTime);
-		MyFill(table,"RelDelayFrontRightTime_nox2_rel_to_frontanode_Cut",8000,-4000,4000,ev.delayFrontRightTime-ev.anodeFrontTime);
-		MyFill(table,"RelDelayBackLeftTime_nox2_rel_to_frontanode_Cut",8000,-4000,4000,ev.delayBackLeftTime-ev.anodeFrontTime);
-		MyFill(table,"RelDelayBackRightTime_nox2_rel_to_frontanode_Cut",8000,-4000,4000,ev.delayBackRightTime-ev.anodeFrontTime);
+		hists.Fill(m_cut.RelDelayFrontLeftTime_nox2_rel_to_frontanode_Cut, ev.delayFrontLeftTime-ev.anodeFrontTime);
+		hists.Fill(m_cut.RelDelayFrontRightTime_nox2_rel_to_frontanode_Cut, ev.delayFrontRightTime-ev.anodeFrontTime);
+		hists.Fill(m_cut.RelDelayBackLeftTime_nox2_rel_to_frontanode_Cut, ev.delayBackLeftTime-ev.anodeFrontTime);
+		hists.Fill(m_cut.RelDelayBackRightTime_nox2_rel_to_frontanode_Cut, ev.delayBackRightTime-ev.anodeFrontTime);
 
-		MyFill(table,"RelDelayFrontLeftTime_nox2_rel_to_backanode_Cut",8000,-4000,4000,ev.delayFrontLeftTime-ev.anodeBackTime);
-		MyFill(table,"RelDelayFrontRightTime_nox2_rel_to_backanode_Cut",8000,-4000,4000,ev.delayFrontRightTime-ev.anodeBackTime);
-		MyFill(table,"RelDelayBackLeftTime_nox2_rel_to_backanode_Cut",8000,-4000,4000,ev.delayBackLeftTime-ev.anodeBackTime);
-		MyFill(table,"RelDelayBackRightTime_nox2_rel_to_backanode_Cut",8000,-4000,4000,ev.delayBackRightTime-ev.anodeBackTime);
+		hists.Fill(m_cut.RelDelayFrontLeftTime_nox2_rel_to_backanode_Cut, ev.delayFrontLeftTime-ev.anodeBackTime);
+		hists.Fill(m_cut.RelDelayFrontRightTime_nox2_rel_to_backanode_Cut, ev.delayFrontRightTime-ev.anodeBackTime);
+		hists.Fill(m_cut.RelDelayBackLeftTime_nox2_rel_to_backanode_Cut, ev.delayBackLeftTime-ev.anodeBackTime);
+		hists.Fill(m_cut.RelDelayBackRightTime_nox2_rel_to_backanode_Cut, ev.delayBackRightTime-ev.anodeBackTime);
 
 		}
 
 		if(ev.x2 != -1e6 && ev.x1 == -1e6){
-		MyFill(table, "x2_only1plane_Cut", 600, -300, 300, ev.x2);
+		hists.Fill(m_cut.x2_only1plane_Cut, ev.x2);
 
-		MyFill(table,"RelDelayFrontLeftTime_nox1_rel_to_frontanode_Cut",8000,-4000,4000,ev.delayFrontLeftTime-ev.anodeFrontTime);
-		MyFill(table,"RelDelayFrontRightTime_nox1_rel_to_frontanode_Cut",8000,-4000,4000,ev.delayFrontRightTime-ev.anodeFrontTime);
-		MyFill(table,"RelDelayBackLeftTime_nox1_rel_to_frontanode_Cut",8000,-4000,4000,ev.delayBackLeftTime-ev.anodeFrontTime);
-		MyFill(table,"RelDelayBackRightTime_nox1_rel_to_frontanode_Cut",8000,-4000,4000,ev.delayBackRightTime-ev.anodeFrontTime);
+		hists.Fill(m_cut.RelDelayFrontLeftTime_nox1_rel_to_frontanode_Cut, ev.delayFrontLeftTime-ev.anodeFrontTime);
+		hists.Fill(m_cut.RelDelayFrontRightTime_nox1_rel_to_frontanode_Cut, ev.delayFrontRightTime-ev.anodeFrontTime);
+		hists.Fill(m_cut.RelDelayBackLeftTime_nox1_rel_to_frontanode_Cut, ev.delayBackLeftTime-ev.anodeFrontTime);
+		hists.Fill(m_cut.RelDelayBackRightTime_nox1_rel_to_frontanode_Cut, ev.delayBackRightTime-ev.anodeFrontTime);
 
-		MyFill(table,"RelDelayFrontLeftTime_nox1_rel_to_backanode_Cut",8000,-4000,4000,ev.delayFrontLeftTime-ev.anodeBackTime);
-		MyFill(table,"RelDelayFrontRightTime_nox1_rel_to_backanode_Cut",8000,-4000,4000,ev.delayFrontRightTime-ev.anodeBackTime);
-		MyFill(table,"RelDelayBackLeftTime_nox1_rel_to_backanode_Cut",8000,-4000,4000,ev.delayBackLeftTime-ev.anodeBackTime);
-		MyFill(table,"RelDelayBackRightTime_nox1_rel_to_backanode_Cut",8000,-4000,4000,ev.delayBackRightTime-ev.anodeBackTime);
+		hists.Fill(m_cut.RelDelayFrontLeftTime_nox1_rel_to_backanode_Cut, ev.delayFrontLeftTime-ev.anodeBackTime);
+		hists.Fill(m_cut.RelDelayFrontRightTime_nox1_rel_to_backanode_Cut, ev.delayFrontRightTime-ev.anodeBackTime);
+		hists.Fill(m_cut.RelDelayBackLeftTime_nox1_rel_to_backanode_Cut, ev.delayBackLeftTime-ev.anodeBackTime);
+		hists.Fill(m_cut.RelDelayBackRightTime_nox1_rel_to_backanode_Cut, ev.delayBackRightTime-ev.anodeBackTime);
 
 		}
 		
-		MyFill(table,"x1_delayBackRightE_Cut",600,-300,300,ev.x1,512,0,4096,ev.delayBackRightE);
-		MyFill(table,"x2_delayBackRightE_Cut",600,-300,300,ev.x2,512,0,4096,ev.delayBackRightE);
-		MyFill(table,"x1_delayBackLeftE_Cut",600,-300,300,ev.x1,512,0,4096,ev.delayBackLeftE);
-		MyFill(table,"x2_delayBackLeftE_Cut",600,-300,300,ev.x2,512,0,4096,ev.delayBackLeftE);
-		MyFill(table,"xavg_delayBackRightE_Cut",600,-300,300,ev.xavg,512,0,4096,ev.delayBackRightE);
-		MyFill(table,"xavg_delayBackLeftE_Cut",600,-300,300,ev.xavg,512,0,4096,ev.delayBackLeftE);
-
-		MyFill(table,"x1_delayFrontRightE_Cut",600,-300,300,ev.x1,512,0,4096,ev.delayFrontRightE);
-		MyFill(table,"x2_delayFrontRightE_Cut",600,-300,300,ev.x2,512,0,4096,ev.delayFrontRightE);
-		MyFill(table,"x1_delayFrontLeftE_Cut",600,-300,300,ev.x1,512,0,4096,ev.delayFrontLeftE);
-		MyFill(table,"x2_delayFrontLeftE_Cut",600,-300,300,ev.x2,512,0,4096,ev.delayFrontLeftE);
-		MyFill(table,"xavg_delayFrontRightE_Cut",600,-300,300,ev.xavg,512,0,4096,ev.delayFrontRightE);
-		MyFill(table,"xavg_delayFrontLeftE_Cut",600,-300,300,ev.xavg,512,0,4096,ev.delayFrontLeftE);
+		hists.Fill(m_cut.x1_delayBackRightE_Cut, ev.x1, ev.delayBackRightE);
+		hists.Fill(m_cut.x2_delayBackRightE_Cut, ev.x2, ev.delayBackRightE);
+		hists.Fill(m_cut.x1_delayBackLeftE_Cut, ev.x1, ev.delayBackLeftE);
+		hists.Fill(m_cut.x2_delayBackLeftE_Cut, ev.x2, ev.delayBackLeftE);
+		hists.Fill(m_cut.xavg_delayBackRightE_Cut, ev.xavg, ev.delayBackRightE);
+		hists.Fill(m_cut.xavg_delayBackLeftE_Cut, ev.xavg, ev.delayBackLeftE);
+
+		hists.Fill(m_cut.x1_delayFrontRightE_Cut, ev.x1, ev.delayFrontRightE);
+		hists.Fill(m_cut.x2_delayFrontRightE_Cut, ev.x2, ev.delayFrontRightE);
+		hists.Fill(m_cut.x1_delayFrontLeftE_Cut, ev.x1, ev.delayFrontLeftE);
+		hists.Fill(m_cut.x2_delayFrontLeftE_Cut, ev.x2, ev.delayFrontLeftE);
+		hists.Fill(m_cut.xavg_delayFrontRightE_Cut, ev.xavg, ev.delayFrontRightE);
+		hists.Fill(m_cut.xavg_delayFrontLeftE_Cut, ev.xavg, ev.delayFrontLeftE);
 	
 		Double_t delayBackAvgE = (ev.delayBackRightE+ev.delayBackLeftE)/2.0;
-		MyFill(table,"x1_delayBackAvgE_Cut",600,-300,300,ev.x1,512,0,4096,delayBackAvgE);
-		MyFill(table,"x2_delayBackAvgE_Cut",600,-300,300,ev.x2,512,0,4096,delayBackAvgE);
-		MyFill(table,"xavg_delayBackAvgE_Cut",600,-300,300,ev.xavg,512,0,4096,delayBackAvgE);
+		hists.Fill(m_cut.x1_delayBackAvgE_Cut, ev.x1, delayBackAvgE);
+		hists.Fill(m_cut.x2_delayBackAvgE_Cut, ev.x2, delayBackAvgE);
+		hists.Fill(m_cut.xavg_delayBackAvgE_Cut, ev.xavg, delayBackAvgE);
 		Double_t delayFrontAvgE = (ev.delayFrontRightE+ev.delayFrontLeftE)/2.0;
-		MyFill(table,"x1_delayFrontAvgE_Cut",600,-300,300,ev.x1,512,0,4096,delayFrontAvgE);
-		MyFill(table,"x2_delayFrontAvgE_Cut",600,-300,300,ev.x2,512,0,4096,delayFrontAvgE);
-		MyFill(table,"xavg_delayFrontAvgE_Cut",600,-300,300,ev.xavg,512,0,4096,delayFrontAvgE);
+		hists.Fill(m_cut.x1_delayFrontAvgE_Cut, ev.x1, delayFrontAvgE);
+		hists.Fill(m_cut.x2_delayFrontAvgE_Cut, ev.x2, delayFrontAvgE);
+		hists.Fill(m_cut.xavg_delayFrontAvgE_Cut, ev.xavg, delayFrontAvgE);
 	
-		MyFill(table,"scintLeft_anodeBack_Cut",512,0,4096,ev.scintLeft,512,0,4096,ev.anodeBack);
-		MyFill(table,"scintLeft_anodeFront_Cut",512,0,4096,ev.scintLeft,512,0,4096,ev.anodeFront);
-		MyFill(table,"scintLeft_cathode_Cut",512,0,4096,ev.scintLeft,512,0,4096,ev.cathode);
+		hists.Fill(m_cut.scintLeft_anodeBack_Cut, ev.scintLeft, ev.anodeBack);
+		hists.Fill(m_cut.scintLeft_anodeFront_Cut, ev.scintLeft, ev.anodeFront);
+		hists.Fill(m_cut.scintLeft_cathode_Cut, ev.scintLeft, ev.cathode);
 
-		MyFill(table,"scintRight_anodeBack_Cut",512,0,4096,ev.scintRight,512,0,4096,ev.anodeBack);
-		MyFill(table,"scintRight_anodeFront_Cut",512,0,4096,ev.scintRight,512,0,4096,ev.anodeFront);
-		MyFill(table,"scintRight_cathode_Cut",512,0,4096,ev.scintRight,512,0,4096,ev.cathode);
+		hists.Fill(m_cut.scintRight_anodeBack_Cut, ev.scintRight, ev.anodeBack);
+		hists.Fill(m_cut.scintRight_anodeFront_Cut, ev.scintRight, ev.anodeFront);
+		hists.Fill(m_cut.scintRight_cathode_Cut, ev.scintRight, ev.cathode);
 	
-		MyFill(table,"x1_scintLeft_Cut",600,-300,300,ev.x1,512,0,4096,ev.scintLeft);
-		MyFill(table,"x2_scintLeft_Cut",600,-300,300,ev.x2,512,0,4096,ev.scintLeft);
-		MyFill(table,"xavg_scintLeft_Cut",600,-300,300,ev.xavg,512,0,4096,ev.scintLeft);
-		MyFill(table,"xavg_scintRight_Cut",600,-300,300,ev.xavg,512,0,4096,ev.scintRight);
+		hists.Fill(m_cut.x1_scintLeft_Cut, ev.x1, ev.scintLeft);
+		hists.Fill(m_cut.x2_scintLeft_Cut, ev.x2, ev.scintLeft);
+		hists.Fill(m_cut.xavg_scintLeft_Cut, ev.xavg, ev.scintLeft);
+		hists.Fill(m_cut.xavg_scintRight_Cut, ev.xavg, ev.scintRight);
 	
-		MyFill(table,"x1_anodeBack_Cut",600,-300,300,ev.x1,512,0,4096,ev.anodeBack);
-		MyFill(table,"x2_anodeBack_Cut",600,-300,300,ev.x2,512,0,4096,ev.anodeBack);
-		MyFill(table,"xavg_anodeBack_Cut",600,-300,300,ev.xavg,512,0,4096,ev.anodeBack);
+		hists.Fill(m_cut.x1_anodeBack_Cut, ev.x1, ev.anodeBack);
+		hists.Fill(m_cut.x2_anodeBack_Cut, ev.x2, ev.anodeBack);
+		hists.Fill(m_cut.xavg_anodeBack_Cut, ev.xavg, ev.anodeBack);
 		
-		MyFill(table,"x1_anodeFront_Cut",600,-300,300,ev.x1,512,0,4096,ev.anodeFront);
-		MyFill(table,"x2_anodeFront_Cut",600,-300,300,ev.x2,512,0,4096,ev.anodeFront);
-		MyFill(table,"xavg_anodeFront_Cut",600,-300,300,ev.xavg,512,0,4096,ev.anodeFront);
+		hists.Fill(m_cut.x1_anodeFront_Cut, ev.x1, ev.anodeFront);
+		hists.Fill(m_cut.x2_anodeFront_Cut, ev.x2, ev.anodeFront);
+		hists.Fill(m_cut.xavg_anodeFront_Cut, ev.xavg, ev.anodeFront);
 		
-		MyFill(table,"x1_cathode_Cut",600,-300,300,ev.x1,512,0,4096,ev.cathode);
-		MyFill(table,"x2_cathode_Cut",600,-300,300,ev.x2,512,0,4096,ev.cathode);
-		MyFill(table,"xavg_cathode_Cut",600,-300,300,ev.xavg,512,0,4096,ev.cathode);
+		hists.Fill(m_cut.x1_cathode_Cut, ev.x1, ev.cathode);
+		hists.Fill(m_cut.x2_cathode_Cut, ev.x2, ev.cathode);
+		hists.Fill(m_cut.xavg_cathode_Cut, ev.xavg, ev.cathode);
 
 		// double cebra_E_ADCShift[5] = {	1.0			*ev.cebraE[0]+ 0.0,
 		// 									1.10926476470248* ev.cebraE[1] +	1.08683520943367,
@@ -384,7 +534,7 @@ namespace EventBuilder {
 		      rangeNum++;
 		    //   Apply the linear gain transformations.
 		    cebra_E_ADCShift[i] = gains.GetIntercept(runNum, rangeNum, i) + gains.GetSlope(runNum, rangeNum, i)*ev.cebraE[i];
-		    cebra_E_ADCShift[i] += gRandom->Rndm()-0.5; // To remove aliasing, assuming 12 bit ADC voltage resolution
+		    cebra_E_ADCShift[i] += worker.random.Rndm()-0.5; // To remove aliasing, assuming 12 bit ADC voltage resolution
 		  } else {
 		    cebra_E_ADCShift[i] = ev.cebraE[i];
 		  }
@@ -401,14 +551,14 @@ namespace EventBuilder {
 			Double_t delayFL_toScint = ev.delayFrontLeftTime - ev.scintLeftTime;
 			Double_t delayBL_toScint = ev.delayBackLeftTime - ev.scintLeftTime;
 			Double_t delayBR_toScint = ev.delayBackRightTime - ev.scintLeftTime;
-			MyFill(table,"anodeRelBackTime_Cut",1000,-3000,3500, anodeRelBT);
-			MyFill(table,"anodeRelFrontTime_Cut",1000,-3000,3500, anodeRelFT);
-			MyFill(table,"anodeRelTime_toScint_Cut",1000,-3000,3500,anodeRelFT_toScint);
-			MyFill(table,"delayFL_RelScint_Cuts",3000,-3000,3000,delayFL_toScint);
-			MyFill(table,"delayFR_RelScint_Cuts",3000,-3000,3000,delayFR_toScint);
-			MyFill(table,"delayBL_RelScint_Cuts",3000,-3000,3000,delayBL_toScint);
-			MyFill(table,"delayBR_RelScint_Cuts",3000,-3000,3000,delayBR_toScint);
-			MyFill(table, "xavg_timeDifferenceScints", 600, -300, 300, ev.xavg, 12800, -3200,3200, ev.scintRightTime - ev.scintLeftTime);
+			hists.Fill(m_cut.anodeRelBackTime_Cut, anodeRelBT);
+			hists.Fill(m_cut.anodeRelFrontTime_Cut, anodeRelFT);
+			hists.Fill(m_cut.anodeRelTime_toScint_Cut, anodeRelFT_toScint);
+			hists.Fill(m_cut.delayFL_RelScint_Cuts, delayFL_toScint);
+			hists.Fill(m_cut.delayFR_RelScint_Cuts, delayFR_toScint);
+			hists.Fill(m_cut.delayBL_RelScint_Cuts, delayBL_toScint);
+			hists.Fill(m_cut.delayBR_RelScint_Cuts, delayBR_toScint);
+			hists.Fill(m_cut.xavg_timeDifferenceScints, ev.xavg, ev.scintRightTime - ev.scintLeftTime);
 
 
 			for(int i=0; i<5; i++) {
@@ -418,8 +568,8 @@ namespace EventBuilder {
 				//CeBrA relative time to right Scint
 				Double_t cebraRelT_toRightScint = ev.cebraTime[i] - ev.scintRightTime;
 
-				MyFill(table,fmt::format("cebra_RelTime_toScint_{}_Cut",i),6400,-3200,3200,cebraRelT_toScint);
-				MyFill(table,fmt::format("cebra_RelTime_toScint_{}_theta_Cut",i),6400,-3200,3200,cebraRelT_toScint,100,0,TMath::Pi()/2.,ev.theta);
+				hists.Fill(m_cut.cebra_RelTime_toScint_N_Cut[i], cebraRelT_toScint);
+				hists.Fill(m_cut.cebra_RelTime_toScint_N_theta_Cut[i], cebraRelT_toScint, ev.theta);
 
 				//adjust accordingly using the "cebra_RelTime_toScint_I" plots
 
@@ -438,32 +588,31 @@ namespace EventBuilder {
 				double cebra_RelTime_Width = 2.9; // LR: Consider using ranges. Detector 4 has a broader peak.
 
 				double cebraRelT_toScint_Shifted = cebraRelT_toScint + cebra_RelTime_toScint_Shift[i];
-				MyFill(table, fmt::format("xavg_vs_timeDiff_cebra{}_scintRight", i), 600, -300, 300, ev.xavg, 6400, -3200, 3200, cebraRelT_toRightScint);
-				MyFill(table, fmt::format("xavg_vs_timeDiff_cebra{}_scintLeft", i), 600, -300, 300, ev.xavg, 6400, -3200, 3200, cebraRelT_toScint);
+				hists.Fill(m_cut.xavg_vs_timeDiff_cebraN_scintRight[i], ev.xavg, cebraRelT_toRightScint);
+				hists.Fill(m_cut.xavg_vs_timeDiff_cebraN_scintLeft[i], ev.xavg, cebraRelT_toScint);
 
 				if(cebraRelT_toScint_Shifted > -cebra_RelTime_Width && cebraRelT_toScint_Shifted < cebra_RelTime_Width){
 					
-					MyFill(table,"xavg_TimeCutShift_Cut",600,-300,300,ev.xavg);
-					MyFill(table,fmt::format("cebra_E_{}_TimeCutShift_Cut",i),512,0,4096,ev.cebraE[i]);
-					MyFill(table,fmt::format("xavg_cebraE_{}_TimeCutShift_Cut",i),600,-300,300,ev.xavg,512,0,4096,ev.cebraE[i]);
-					MyFill(table,fmt::format("x1_cebraE_{}_TimeCutShift_Cut",i),600,-300,300,ev.x1,512,0,4096,ev.cebraE[i]);
-					MyFill(table,fmt::format("cebra_RelTime_toScint_{}_TimeCutShift_Cut",i),400,-100,100,cebraRelT_toScint_Shifted);
+					hists.Fill(m_cut.xavg_TimeCutShift_Cut, ev.xavg);
+					hists.Fill(m_cut.cebra_E_N_TimeCutShift_Cut[i], ev.cebraE[i]);
+					hists.Fill(m_cut.xavg_cebraE_N_TimeCutShift_Cut[i], ev.xavg, ev.cebraE[i]);
+					hists.Fill(m_cut.x1_cebraE_N_TimeCutShift_Cut[i], ev.x1, ev.cebraE[i]);
+					hists.Fill(m_cut.cebra_RelTime_toScint_N_TimeCutShift_Cut[i], cebraRelT_toScint_Shifted);
 
 					//All the detectors summed using the ADC Shift values
-					MyFill(table,"AA_xavg_cebraE_Sum_TimeCutShift_Cut",600,-300,300,ev.xavg,512,0,4096,cebra_E_ADCShift[i]);
-					MyFill(table,"AA_x1_cebraE_Sum_TimeCutShift_Cut",600,-300,300,ev.x1,512,0,4096,cebra_E_ADCShift[i]);
+					hists.Fill(m_cut.AA_xavg_cebraE_Sum_TimeCutShift_Cut, ev.xavg, cebra_E_ADCShift[i]);
+					hists.Fill(m_cut.AA_x1_cebraE_Sum_TimeCutShift_Cut, ev.x1, cebra_E_ADCShift[i]);
 
 					double cebra_E_EnergyCalibrated = -3.1747e-06*cebra_E_ADCShift[i]*cebra_E_ADCShift[i]
 					  + 1.7366*cebra_E_ADCShift[i] + 3.0;
 					
 					double xavg_calibrated = -2.2631e-03*ev.xavg - 18.516*ev.xavg + 1353.3;
 
-					MyFill(table,"AA_xavg_cebraE_Sum_EnergyCalibrated_TimeCutShift_Cut",600,-300,300,ev.xavg,2048, 0, 8192,cebra_E_EnergyCalibrated);
-					MyFill(table,"AA_x1_cebraE_Sum_EnergyCalibrated_TimeCutShift_Cut",600,-300,300,ev.x1,2048, 0, 8192,cebra_E_EnergyCalibrated);
+					hists.Fill(m_cut.AA_xavg_cebraE_Sum_EnergyCalibrated_TimeCutShift_Cut, ev.xavg, cebra_E_EnergyCalibrated);
+					hists.Fill(m_cut.AA_x1_cebraE_Sum_EnergyCalibrated_TimeCutShift_Cut, ev.x1, cebra_E_EnergyCalibrated);
 
-					MyFill(table,"AA_ENERGYCAL_xavg_cebraE_TimeCutShift_Cut", 1024, 0, 8192, xavg_calibrated,
-					                                                          2048, 0, 8192, cebra_E_EnergyCalibrated);
-					MyFill(table, "AA_ENERGYCAL_xavg_TimeCutShift_Cut", 2048, 0, 8192, xavg_calibrated);
+					hists.Fill(m_cut.AA_ENERGYCAL_xavg_cebraE_TimeCutShift_Cut, xavg_calibrated, cebra_E_EnergyCalibrated);
+					hists.Fill(m_cut.AA_ENERGYCAL_xavg_TimeCutShift_Cut, xavg_calibrated);
 
 					// Conditional statement that plots certain decay bands of interest
 					
@@ -489,16 +638,16 @@ namespace EventBuilder {
 				
 
 
-					MyFill(table, "AA_cebraE_Sum_ADCShift_TimeCutShift_Cut", 1024, 0, 4096, cebra_E_ADCShift[i]);
-					MyFill(table, "AA_cebraE_Sum_EnergyCal_TimeCutShift_Cut", 2048, 0, 8192, cebra_E_EnergyCalibrated);
+					hists.Fill(m_cut.AA_cebraE_Sum_ADCShift_TimeCutShift_Cut, cebra_E_ADCShift[i]);
+					hists.Fill(m_cut.AA_cebraE_Sum_EnergyCal_TimeCutShift_Cut, cebra_E_EnergyCalibrated);
 
 
 
 					//Zony plots (small CeBr3 detectors, small zebras, like a small horses or a pony)
 					if(i != 4){
 							// MyFill(table,"cebraE_zony_cebraE4_TimeCut_Cut",512,0,4096,cebra_E_ADCShift[i],512,0,4096,cebra_E_ADCShift[4]);
-							MyFill(table,"xavg_cebraE_zony_TimeCutShift_Cut",600,-300,300,ev.xavg,512,0,4096,cebra_E_ADCShift[i]);
-							MyFill(table,"x1_cebraE_zony_TimeCutShift_Cut",600,-300,300,ev.x1,512,0,4096,cebra_E_ADCShift[i]);
+							hists.Fill(m_cut.xavg_cebraE_zony_TimeCutShift_Cut, ev.xavg, cebra_E_ADCShift[i]);
+							hists.Fill(m_cut.x1_cebraE_zony_TimeCutShift_Cut, ev.x1, cebra_E_ADCShift[i]);
 							//MyFill(table,"AA_xavg_cebraE_zony_EnergyCalibrated_TimeCutShift_Cut",600,-300,300,ev.xavg,2048, 0, 8192,cebra_E_EnergyCalibrated);
 							//MyFill(table,"AA_x1_cebraE_zony_EnergyCalibrated_TimeCutShift_Cut",600,-300,300,ev.x1,2048, 0, 8192,cebra_E_EnergyCalibrated);
 							
@@ -530,16 +679,16 @@ namespace EventBuilder {
 			for(int i=0; i<5; i++) {
        			if(ev.cebraE[i] != -1 && ev.x1 != -1e6 && ev.x2 != -1e6){
 	
-					MyFill(table,fmt::format("cebra_E_{}_Cut",i),1024,0,4096,ev.cebraE[i]);
-					MyFill(table,fmt::format("cebra_E_{}_ADCShift_Cut",i),1024,0,4096,cebra_E_ADCShift[i]);
-					MyFill(table,"cebra_E_ADCShift_Cut",1024,0,4096,cebra_E_ADCShift[i]);
+					hists.Fill(m_cut.cebra_E_N_Cut[i], ev.cebraE[i]);
+					hists.Fill(m_cut.cebra_E_N_ADCShift_Cut[i], cebra_E_ADCShift[i]);
+					hists.Fill(m_cut.cebra_E_ADCShift_Cut, cebra_E_ADCShift[i]);
 					// MyFill(table,fmt::format("xavg_cebraE_{}_Cut",i),600,-300,300,ev.xavg,1024,0,4096,ev.cebraE[i]);
 					// MyFill(table,"xavg_cebraE_Cut",600,-300,300,ev.xavg,1024,0,4096,ev.cebraE[i]);
 					// MyFill(table,fmt::format("x1_cebraE_{}_Cut",i),600,-300,300,ev.x1,1024,0,4096,ev.cebraE[i]);
 					// MyFill(table,"x1_cebraE_Cut",600,-300,300,ev.x1,1024,0,4096,ev.cebraE[i]);
 
 					//CeBrA vs xavg without the time cut
-					MyFill(table,"AA_xavg_cebraE_Sum_Cut",600,-300,300,ev.xavg,512,0,4096,cebra_E_ADCShift[i]);
+					hists.Fill(m_cut.AA_xavg_cebraE_Sum_Cut, ev.xavg, cebra_E_ADCShift[i]);
 
 				}
 			}
@@ -555,50 +704,122 @@ namespace EventBuilder {
 		
 	}
 	
-	/*Runs a list of files given from a RunCollector class*/
+	/*
+		Histograms the runs of files[] claimed through nextFile, one whole run at a time, into the worker's set.
+		Entries are counted into processed every s_progressStride entries, for the progress report.
+	*/
+	void SFPPlotter::PlotFiles(const std::vector<std::string>& files, PlotWorker& worker, std::atomic<std::size_t>& nextFile, std::atomic<long>& processed)
+	{
+		std::size_t index;
+		while((index = nextFile++) < files.size())
+		{
+			TFile* file = TFile::Open(files[index].c_str(), "READ");
+			TTree* tree = file != nullptr && file->IsOpen() ? (TTree*) file->Get("SPSTree") : nullptr;
+			if(tree == nullptr)
+			{
+				EVB_WARN("Unable to read SPSTree from {0} at SFPPlotter::PlotFiles(); run skipped.", files[index]);
+				delete file;
+				continue;
+			}
+			ProcessedEvent* address = &worker.event;
+			tree->SetBranchAddress("event", &address);
+
+			//LR Get the run number out of the filename of the current file.
+			TString name = file->GetName();
+			Int_t istart = name.First('_')+1;
+			Int_t istop = name.First('.');
+			TString runNumber = name(istart, istop-istart);
+			int runNum = runNumber.Atoi();
+
+			long nentries = tree->GetEntries(), counted = 0;
+			for(long i=0; i<nentries; i++)
+			{
+				tree->GetEntry(i);
+				if(m_spec.IsValid())
+					m_spec.Fill(worker.event, m_spec.UsesCuts() ? worker.cuts.GetInsideMask(&worker.event) : 0, worker.hists);
+				else
+				{
+					MakeUncutHistograms(worker.event, worker, runNum);
+					if(worker.cuts.IsValid()) MakeCutHistograms(worker.event, worker, runNum);
+				}
+				if(++counted == s_progressStride)
+				{
+					processed += counted;
+					counted = 0;
+				}
+			}
+			processed += counted;
+
+			file->Close();
+			delete file;
+		}
+	}
+
+	/*
+		Runs a list of files given from a RunCollector class. The runs are shared out to m_nThreads workers, each with its
+		own histogram set (booked like the first, so the same handles fill it) and random generator for the CeBrA
+		dithering; the cuts, compiled once, are shared. The sets are summed into the first once every run is done;
+		progress is reported from this thread.
+	*/
 	void SFPPlotter::Run(const std::vector<std::string>& files, const std::string& output)
 	{
+		//ROOT must be made thread safe before any file is opened
+		std::size_t nworkers = std::max<std::size_t>(std::min<std::size_t>(m_nThreads, files.size()), 1);
+		if(nworkers > 1)
+			ROOT::EnableThreadSafety();
+
 		TFile *outfile = TFile::Open(output.c_str(), "RECREATE");
 		TChain* chain = new TChain("SPSTree");
 		for(unsigned int i=0; i<files.size(); i++)
 			chain->Add(files[i].c_str()); 
-		chain->SetBranchAddress("event", &event_address);
-		THashTable* table = new THashTable();
-	
 		long blentries = chain->GetEntries();
-		long count=0, flush_val=blentries*m_progressFraction, flush_count=0;
-	
-	
-		for(long i=0; i<chain->GetEntries(); i++) 
+		long flush_val = std::max(long(blentries*m_progressFraction), 1L);
+		delete chain;
+
+		//Everything touching ROOT directories (booking) is done here, before the workers start
+		std::vector<std::unique_ptr<PlotWorker>> workers;
+		for(std::size_t i=0; i<nworkers; i++)
+		{
+			workers.push_back(std::make_unique<PlotWorker>(cutter, i+1));
+			if(i == 0)
+				BookHistograms(workers[0]->hists);
+			else
+				workers[i]->hists.BookLike(workers[0]->hists);
+		}
+		if(nworkers > 1)
+			EVB_INFO("Plotting {0} runs with {1} threads.", files.size(), nworkers);
+
+		std::atomic<std::size_t> nextFile(0);
+		std::atomic<long> processed(0);
+		std::vector<std::future<void>> jobs;
+		for(auto& worker : workers)
+			jobs.push_back(std::async(std::launch::async, &SFPPlotter::PlotFiles, this, std::cref(files), std::ref(*worker), std::ref(nextFile), std::ref(processed)));
+
+		long reported = 0;
+		for(auto& job : jobs)
 		{
-			count++;
-			if(count == flush_val)
+			while(job.wait_for(std::chrono::milliseconds(200)) != std::future_status::ready)
 			{
-				flush_count++;
-				count=0;
-				m_progressCallback(flush_count*flush_val, blentries);
+				long done = processed;
+				if(done - reported >= flush_val)
+				{
+					reported = done;
+					m_progressCallback(done, blentries);
+				}
 			}
-			chain->GetEntry(i);
-
-			//LR Get the run number out of the filename of the current file in the TChain.
-			TString name = chain->GetFile()->GetName();
-			Int_t istart = name.First('_')+1;
-			Int_t istop = name.First('.');
-			TString runNumber = name(istart, istop-istart);
-			int runNum = runNumber.Atoi();
-			
-			MakeUncutHistograms(*event_address, table, runNum);
-			if(cutter.IsValid()) MakeCutHistograms(*event_address, table, runNum);
 		}
+
+		for(std::size_t i=1; i<nworkers; i++)
+			workers[0]->hists.Add(workers[i]->hists);
+
 		outfile->cd();
-		table->Write();
+		workers[0]->hists.Write();
 		if(cutter.IsValid()) 
 		{
 			auto clist = cutter.GetCuts();
 			for(unsigned int i=0; i<clist.size(); i++) 
 			  clist[i]->Write();
 		}
-		delete table;
 		outfile->Close();
 		delete outfile;
 	}
@@ -13,6 +13,11 @@
 #include "ProgressCallback.h"
 #include "CutHandler.h"
 #include "CebraGainMap.h"
+#include "HistogramRegistry.h"
+#include "HistogramSpec.h"
+#include <TRandom3.h>
+#include <array>
+#include <atomic>
 
 namespace EventBuilder {
 
@@ -22,25 +27,212 @@ namespace EventBuilder {
 		SFPPlotter();
 		~SFPPlotter();
 		inline void ApplyCutlist(const std::string& listname) { cutter.SetCuts(listname); }
+		inline void SetThreads(int n) { m_nThreads = n > 1 ? n : 1; }
+		inline void SetCutRaster(int cells) { cutter.SetRasterSize(cells); } //see CutHandler::SetRasterSize
+		inline bool ReadHistogramSpec(const std::string& filename) { return m_spec.ReadFile(filename, cutter); } //replaces the built in histograms; after ApplyCutlist, for the gates
 	        inline void ReadCebraGains(const std::string& name) { gains.FillMap(name); }
 		void Run(const std::vector<std::string>& files, const std::string& output);
 		inline void SetProgressCallbackFunc(const ProgressCallbackFunc& function) { m_progressCallback = function; }
 		inline void SetProgressFraction(double frac) { m_progressFraction = frac; }
 	
 	private:
+		using Hist1D = HistogramRegistry::Handle1D;
+		using Hist2D = HistogramRegistry::Handle2D;
+
+		//Handles of the histograms of MakeUncutHistograms and MakeCutHistograms; the CeBrA arrays are by detector
+		struct UncutHistograms
+		{
+			Hist1D x1NoCuts_bothplanes;
+			Hist1D x2NoCuts_bothplanes;
+			Hist1D xavgNoCuts_bothplanes;
+			Hist2D xavgNoCuts_theta_bothplanes;
+			Hist2D x1_delayBackRightE_NoCuts;
+			Hist2D x2_delayBackRightE_NoCuts;
+			Hist2D x1_delayBackLeftE_NoCuts;
+			Hist2D x2_delayBackLeftE_NoCuts;
+			Hist2D xavg_delayBackRightE_NoCuts;
+			Hist2D xavg_delayBackLeftE_NoCuts;
+			Hist2D x1_x2_NoCuts;
+			Hist2D x1_delayBackAvgE_NoCuts;
+			Hist2D x2_delayBackAvgE_NoCuts;
+			Hist2D xavg_delayBackAvgE_NoCuts;
+			Hist2D x1_delayFrontAvgE_NoCuts;
+			Hist2D x2_delayFrontAvgE_NoCuts;
+			Hist2D xavg_delayFrontAvgE_NoCuts;
+			Hist2D scintLeft_anodeBack_NoCuts;
+			Hist2D scintLeft_anodeFront_NoCuts;
+			Hist2D scintLeft_cathode_NoCuts;
+			Hist2D scintRight_anodeBack_NoCuts;
+			Hist2D scintRight_anodeFront_NoCuts;
+			Hist2D scintRight_cathode_NoCuts;
+			Hist2D x1_scintLeft_NoCuts;
+			Hist2D x2_scintLeft_NoCuts;
+			Hist2D xavg_scintLeft_NoCuts;
+			Hist2D xavg_scintRight_NoCuts;
+			Hist2D x1_anodeBack_NoCuts;
+			Hist2D x2_anodeBack_NoCuts;
+			Hist2D xavg_anodeBack_NoCuts;
+			Hist2D x1_anodeFront_NoCuts;
+			Hist2D x2_anodeFront_NoCuts;
+			Hist2D xavg_anodeFront_NoCuts;
+			Hist2D x1_cathode_NoCuts;
+			Hist2D x2_cathode_NoCuts;
+			Hist2D xavg_cathode_NoCuts;
+			Hist2D x1_delayFrontRightE_noCuts;
+			Hist2D x2_delayFrontRightE_noCuts;
+			Hist2D x1_delayFrontLeftE_noCuts;
+			Hist2D x2_delayFrontLeftE_noCuts;
+			Hist2D xavg_delayFrontRightE_noCuts;
+			Hist2D xavg_delayFrontLeftE_noCuts;
+			Hist1D anodeRelFrontTime_NoCuts;
+			Hist1D delayRelFrontTime_NoCuts;
+			Hist1D delayRelBackTime_NoCuts;
+			Hist1D delayFL_RelScint_NoCuts;
+			Hist1D delayFR_RelScint_NoCuts;
+			Hist1D delayBL_RelScint_NoCuts;
+			Hist1D delayBR_RelScint_NoCuts;
+			std::array<Hist1D, 5> cebra_RelTime_toScint_N_noCuts;
+			Hist1D anodeBackRelTime_toScint;
+			Hist1D delayRelBackTime_toScint;
+			Hist1D delayRelFrontTime_toScint;
+			Hist1D noscinttime_counter_NoCuts;
+			std::array<Hist1D, 5> cebra_E_N_noCuts;
+			std::array<Hist2D, 5> cebra_E_N_cebraTime_noCuts;
+			std::array<Hist1D, 5> cebra_E_N_ADCShift_noCuts;
+			Hist1D cebra_E_ADCShift_noCuts;
+			std::array<Hist2D, 5> cebra_E_N_ADCShift_cebraTime_noCuts;
+			Hist1D x1NoCuts_only1plane;
+			Hist1D x2NoCuts_only1plane;
+			Hist1D nopos_counter;
+		};
+		struct CutHistograms
+		{
+			Hist1D x1_bothplanes_Cut;
+			Hist1D x2_bothplanes_Cut;
+			Hist1D RelDelayFrontLeftTime_rel_to_frontanode_Cut;
+			Hist1D RelDelayFrontRightTime_rel_to_frontanode_Cut;
+			Hist1D RelDelayBackLeftTime_rel_to_backanode_Cut;
+			Hist1D RelDelayBackRightTime_rel_to_backanode_Cut;
+			Hist1D xavg_bothplanes_Cut;
+			Hist2D x1_x2_Cut;
+			Hist2D xavg_theta_Cut_bothplanes;
+			Hist1D x1_only1plane_Cut;
+			Hist1D RelDelayFrontLeftTime_nox2_rel_to_frontanode_Cut;
+			Hist1D RelDelayFrontRightTime_nox2_rel_to_frontanode_Cut;
+			Hist1D RelDelayBackLeftTime_nox2_rel_to_frontanode_Cut;
+			Hist1D RelDelayBackRightTime_nox2_rel_to_frontanode_Cut;
+			Hist1D RelDelayFrontLeftTime_nox2_rel_to_backanode_Cut;
+			Hist1D RelDelayFrontRightTime_nox2_rel_to_backanode_Cut;
+			Hist1D RelDelayBackLeftTime_nox2_rel_to_backanode_Cut;
+			Hist1D RelDelayBackRightTime_nox2_rel_to_backanode_Cut;
+			Hist1D x2_only1plane_Cut;
+			Hist1D RelDelayFrontLeftTime_nox1_rel_to_frontanode_Cut;
+			Hist1D RelDelayFrontRightTime_nox1_rel_to_frontanode_Cut;
+			Hist1D RelDelayBackLeftTime_nox1_rel_to_frontanode_Cut;
+			Hist1D RelDelayBackRightTime_nox1_rel_to_frontanode_Cut;
+			Hist1D RelDelayFrontLeftTime_nox1_rel_to_backanode_Cut;
+			Hist1D RelDelayFrontRightTime_nox1_rel_to_backanode_Cut;
+			Hist1D RelDelayBackLeftTime_nox1_rel_to_backanode_Cut;
+			Hist1D RelDelayBackRightTime_nox1_rel_to_backanode_Cut;
+			Hist2D x1_delayBackRightE_Cut;
+			Hist2D x2_delayBackRightE_Cut;
+			Hist2D x1_delayBackLeftE_Cut;
+			Hist2D x2_delayBackLeftE_Cut;
+			Hist2D xavg_delayBackRightE_Cut;
+			Hist2D xavg_delayBackLeftE_Cut;
+			Hist2D x1_delayFrontRightE_Cut;
+			Hist2D x2_delayFrontRightE_Cut;
+			Hist2D x1_delayFrontLeftE_Cut;
+			Hist2D x2_delayFrontLeftE_Cut;
+			Hist2D xavg_delayFrontRightE_Cut;
+			Hist2D xavg_delayFrontLeftE_Cut;
+			Hist2D x1_delayBackAvgE_Cut;
+			Hist2D x2_delayBackAvgE_Cut;
+			Hist2D xavg_delayBackAvgE_Cut;
+			Hist2D x1_delayFrontAvgE_Cut;
+			Hist2D x2_delayFrontAvgE_Cut;
+			Hist2D xavg_delayFrontAvgE_Cut;
+			Hist2D scintLeft_anodeBack_Cut;
+			Hist2D scintLeft_anodeFront_Cut;
+			Hist2D scintLeft_cathode_Cut;
+			Hist2D scintRight_anodeBack_Cut;
+			Hist2D scintRight_anodeFront_Cut;
+			Hist2D scintRight_cathode_Cut;
+			Hist2D x1_scintLeft_Cut;
+			Hist2D x2_scintLeft_Cut;
+			Hist2D xavg_scintLeft_Cut;
+			Hist2D xavg_scintRight_Cut;
+			Hist2D x1_anodeBack_Cut;
+			Hist2D x2_anodeBack_Cut;
+			Hist2D xavg_anodeBack_Cut;
+			Hist2D x1_anodeFront_Cut;
+			Hist2D x2_anodeFront_Cut;
+			Hist2D xavg_anodeFront_Cut;
+			Hist2D x1_cathode_Cut;
+			Hist2D x2_cathode_Cut;
+			Hist2D xavg_cathode_Cut;
+			Hist1D anodeRelBackTime_Cut;
+			Hist1D anodeRelFrontTime_Cut;
+			Hist1D anodeRelTime_toScint_Cut;
+			Hist1D delayFL_RelScint_Cuts;
+			Hist1D delayFR_RelScint_Cuts;
+			Hist1D delayBL_RelScint_Cuts;
+			Hist1D delayBR_RelScint_Cuts;
+			Hist2D xavg_timeDifferenceScints;
+			std::array<Hist1D, 5> cebra_RelTime_toScint_N_Cut;
+			std::array<Hist2D, 5> cebra_RelTime_toScint_N_theta_Cut;
+			std::array<Hist2D, 5> xavg_vs_timeDiff_cebraN_scintRight;
+			std::array<Hist2D, 5> xavg_vs_timeDiff_cebraN_scintLeft;
+			Hist1D xavg_TimeCutShift_Cut;
+			std::array<Hist1D, 5> cebra_E_N_TimeCutShift_Cut;
+			std::array<Hist2D, 5> xavg_cebraE_N_TimeCutShift_Cut;
+			std::array<Hist2D, 5> x1_cebraE_N_TimeCutShift_Cut;
+			std::array<Hist1D, 5> cebra_RelTime_toScint_N_TimeCutShift_Cut;
+			Hist2D AA_xavg_cebraE_Sum_TimeCutShift_Cut;
+			Hist2D AA_x1_cebraE_Sum_TimeCutShift_Cut;
+			Hist2D AA_xavg_cebraE_Sum_EnergyCalibrated_TimeCutShift_Cut;
+			Hist2D AA_x1_cebraE_Sum_EnergyCalibrated_TimeCutShift_Cut;
+			Hist2D AA_ENERGYCAL_xavg_cebraE_TimeCutShift_Cut;
+			Hist1D AA_ENERGYCAL_xavg_TimeCutShift_Cut;
+			Hist1D AA_cebraE_Sum_ADCShift_TimeCutShift_Cut;
+			Hist1D AA_cebraE_Sum_EnergyCal_TimeCutShift_Cut;
+			Hist2D xavg_cebraE_zony_TimeCutShift_Cut;
+			Hist2D x1_cebraE_zony_TimeCutShift_Cut;
+			std::array<Hist1D, 5> cebra_E_N_Cut;
+			std::array<Hist1D, 5> cebra_E_N_ADCShift_Cut;
+			Hist1D cebra_E_ADCShift_Cut;
+			Hist2D AA_xavg_cebraE_Sum_Cut;
+		};
+
+		//Everything a plotting thread fills or changes
+		struct PlotWorker
+		{
+			PlotWorker(const CutHandler& cutter, unsigned int seed) :
+				cuts(cutter), random(seed)
+			{
+			}
+
+			HistogramRegistry hists;
+			const CutHandler& cuts; //shared by every worker; compiled once, and only read while plotting
+			TRandom3 random;
+			ProcessedEvent event;
+		};
+
 		void Chain(const std::vector<std::string>& files); //Form TChain
-		void MakeUncutHistograms(const ProcessedEvent& ev, THashTable* table, int runNum);
-                void MakeCutHistograms(const ProcessedEvent& ev, THashTable* table, int runNum);
-	
-		/*Histogram fill wrapper functions*/
-		void MyFill(THashTable* table, const std::string& name, int binsx, double minx, double maxx, double valuex,
-					int binsy, double miny, double maxy, double valuey);
-		void MyFill(THashTable* table, const std::string& name, int binsx, double minx, double maxx, double valuex);
+		void BookHistograms(HistogramRegistry& hists);
+		void PlotFiles(const std::vector<std::string>& files, PlotWorker& worker, std::atomic<std::size_t>& nextFile, std::atomic<long>& processed);
+		void MakeUncutHistograms(const ProcessedEvent& ev, PlotWorker& worker, int runNum);
+		void MakeCutHistograms(const ProcessedEvent& ev, PlotWorker& worker, int runNum);
 	
-		ProcessedEvent *event_address;
+		UncutHistograms m_uncut;
+		CutHistograms m_cut;
+		HistogramSpec m_spec; //when valid, plotted in place of the built in histograms
 	
 		/*Cuts*/
-		CutHandler cutter;
+		CutHandler cutter; //read by every worker, and written to the output
+
+		int m_nThreads;
+		static constexpr long s_progressStride = 4096; //entries a worker plots between progress updates
 
                 CebraGainMap gains;
 	  
@@ -0,0 +1,150 @@
+/*
+	SPSCQueue.h
+	Bounded lock-free ring buffer connecting exactly one producer thread to exactly one consumer thread.
+	Used to pass batches of hits/events between the stages of the pipelined conversion. The producer
+	Close()s the queue when it is done; the consumer then drains whatever is left. A side that finds the queue
+	full/empty sleeps on a condition variable until the other side moves, so a stage waiting on a slower one
+	costs no CPU; the handshake takes a lock once per item, so a queue should carry batches rather than single
+	items. A consumer of several queues can instead sleep on a QueueSignal shared by all of them.
+*/
+#ifndef SPSCQUEUE_H
+#define SPSCQUEUE_H
+
+#include <atomic>
+#include <condition_variable>
+#include <chrono>
+#include <mutex>
+#include <vector>
+
+namespace EventBuilder {
+
+	/*Counts the pushes and closes of the queues it is attached to, for a consumer waiting on any of them*/
+	class QueueSignal
+	{
+	public:
+		QueueSignal() :
+			m_count(0)
+		{
+		}
+
+		void Notify()
+		{
+			{
+				std::lock_guard<std::mutex> guard(m_mutex);
+				m_count++;
+			}
+			m_condition.notify_all();
+		}
+
+		uint64_t GetCount()
+		{
+			std::lock_guard<std::mutex> guard(m_mutex);
+			return m_count;
+		}
+
+		//Sleep until a notification after count was read, or for at most timeout
+		void Wait(uint64_t count, std::chrono::milliseconds timeout)
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_condition.wait_for(lock, timeout, [this, count]() { return m_count != count; });
+		}
+
+	private:
+		std::mutex m_mutex;
+		std::condition_variable m_condition;
+		uint64_t m_count;
+	};
+
+	template<typename T>
+	class SPSCQueue
+	{
+	public:
+		SPSCQueue(std::size_t capacity) :
+			m_slots(capacity + 1), m_head(0), m_tail(0), m_closed(false), m_signal(nullptr)
+		{
+		}
+
+		inline void SetSignal(QueueSignal* signal) { m_signal = signal; } //before either side starts
+
+		/*Producer side*/
+		void Push(T&& item)
+		{
+			std::size_t tail = m_tail.load(std::memory_order_relaxed);
+			std::size_t next = Next(tail);
+			if(next == m_head.load(std::memory_order_acquire))
+			{
+				std::unique_lock<std::mutex> lock(m_mutex);
+				m_condition.wait(lock, [this, next]() { return next != m_head.load(std::memory_order_acquire); });
+			}
+			m_slots[tail] = std::move(item);
+			m_tail.store(next, std::memory_order_release);
+			Notify();
+		}
+
+		void Close()
+		{
+			m_closed.store(true, std::memory_order_release);
+			Notify();
+		}
+
+		/*Consumer side*/
+		bool TryPop(T& item)
+		{
+			std::size_t head = m_head.load(std::memory_order_relaxed);
+			if(head == m_tail.load(std::memory_order_acquire))
+				return false;
+			item = std::move(m_slots[head]);
+			m_head.store(Next(head), std::memory_order_release);
+			{
+				std::lock_guard<std::mutex> guard(m_mutex); //so that a producer can't miss the wake up between its check and its wait
+			}
+			m_condition.notify_all();
+			return true;
+		}
+
+		//Blocks until an item is available; false once the queue is closed and drained
+		bool Pop(T& item)
+		{
+			while(!TryPop(item))
+			{
+				if(m_closed.load(std::memory_order_acquire))
+					return TryPop(item);
+				std::unique_lock<std::mutex> lock(m_mutex);
+				m_condition.wait(lock, [this]()
+				{
+					return m_head.load(std::memory_order_relaxed) != m_tail.load(std::memory_order_acquire) || m_closed.load(std::memory_order_acquire);
+				});
+			}
+			return true;
+		}
+
+		bool IsFinished() const
+		{
+			return m_closed.load(std::memory_order_acquire) && m_head.load(std::memory_order_relaxed) == m_tail.load(std::memory_order_acquire);
+		}
+
+	private:
+		std::size_t Next(std::size_t index) const { return index + 1 == m_slots.size() ? 0 : index + 1; }
+
+		void Notify()
+		{
+			{
+				std::lock_guard<std::mutex> guard(m_mutex); //see TryPop
+			}
+			m_condition.notify_all();
+			if(m_signal != nullptr)
+				m_signal->Notify();
+		}
+
+		std::vector<T> m_slots; //one slot is always left empty to tell full from empty
+		alignas(64) std::atomic<std::size_t> m_head; //next slot to read; written by the consumer only
+		alignas(64) std::atomic<std::size_t> m_tail; //next slot to write; written by the producer only
+		std::atomic<bool> m_closed;
+		std::mutex m_mutex; //only for sleeping on a full/empty queue
+		std::condition_variable m_condition;
+		QueueSignal* m_signal; //NOT owned; notified of every push and the close, if set
+	};
+
+}
+
+#endif
@@ -24,6 +24,7 @@ namespace EventBuilder {
 		inline bool IsValid() { return m_validFlag; }
 		inline std::string GetFilename() { return m_filename; }
 		uint64_t GetShift(int gchan);
+		inline const std::unordered_map<int, uint64_t>* GetSMap() { return &m_map; }
 	
 	private:
 		void ParseFile();
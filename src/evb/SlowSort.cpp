@@ -22,19 +22,41 @@ namespace EventBuilder {
 
 	/*Constructor takes input of coincidence window size, and fills sabre channel map*/
 	SlowSort::SlowSort() :
-		m_coincWindow(-1.0), m_eventFlag(false)
+		m_coincWindow(0), m_eventFlag(false), startTime(0), previousHitTime(0), m_droppedHits(0)
 	{
 		event_stats = new TH2F("coinc_event_stats","coinc_events_stats;global channel;number of coincident hits;counts",144,0,144,20,0,20);
+		event_stats->SetDirectory(nullptr); //owned by SlowSort, so it can be written to any number of output files
 	}
 	
 	SlowSort::SlowSort(double windowSize, const std::string& mapfile) :
-		m_coincWindow(windowSize), m_eventFlag(false), m_event(), cmap(mapfile)
+		m_coincWindow(ToPicoseconds(windowSize)), m_eventFlag(false), m_event(), startTime(0), previousHitTime(0), m_droppedHits(0), cmap(mapfile)
 	{
 		event_stats = new TH2F("coinc_event_stats","coinc_events_stats;global channel;number of coincident hits;counts",144,0,144,20,0,20);
+		event_stats->SetDirectory(nullptr); //owned by SlowSort, so it can be written to any number of output files
+		m_channels.SetChannels(cmap);
+		InitVariableMaps();
+	}
+
+	/*Takes the channel assignments from a prebuilt table rather than parsing a map file*/
+	SlowSort::SlowSort(double windowSize, const ChannelTable& channels) :
+		m_coincWindow(ToPicoseconds(windowSize)), m_eventFlag(false), m_event(), startTime(0), previousHitTime(0), m_droppedHits(0), m_channels(channels)
+	{
+		event_stats = new TH2F("coinc_event_stats","coinc_events_stats;global channel;number of coincident hits;counts",144,0,144,20,0,20);
+		event_stats->SetDirectory(nullptr); //owned by SlowSort, so it can be written to any number of output files
 		InitVariableMaps();
 	}
 	
-	SlowSort::~SlowSort() {}
+	SlowSort::~SlowSort()
+	{
+		delete event_stats;
+	}
+	
+	bool SlowSort::SetMapFile(const std::string& mapfile)
+	{
+		bool valid = cmap.FillMap(mapfile);
+		m_channels.SetChannels(cmap);
+		return valid;
+	}
 	
 	/**EXPERIMENT MODS go here**/
 	void SlowSort::InitVariableMaps() 
@@ -42,65 +64,102 @@ namespace EventBuilder {
 	
 		/*For SABRE: Each SABRE det has ring&wedge, so add the detID to the
 		  SABRERING/WEDGE attribute to differentiate*/
-	/*	varMap[DetAttribute::SabreRing0] = &m_event.sabreArray[0].rings;
-		varMap[DetAttribute::SabreRing1] = &m_event.sabreArray[1].rings;
-		varMap[DetAttribute::SabreRing2] = &m_event.sabreArray[2].rings;
-		varMap[DetAttribute::SabreRing3] = &m_event.sabreArray[3].rings;
-		varMap[DetAttribute::SabreRing4] = &m_event.sabreArray[4].rings;
-		varMap[DetAttribute::SabreWedge0] = &m_event.sabreArray[0].wedges;
-		varMap[DetAttribute::SabreWedge1] = &m_event.sabreArray[1].wedges;
-		varMap[DetAttribute::SabreWedge2] = &m_event.sabreArray[2].wedges;
-		varMap[DetAttribute::SabreWedge3] = &m_event.sabreArray[3].wedges;
-		varMap[DetAttribute::SabreWedge4] = &m_event.sabreArray[4].wedges;
+	/*	varTable[DetAttribute::SabreRing0] = &m_event.sabreArray[0].rings;
+		varTable[DetAttribute::SabreRing1] = &m_event.sabreArray[1].rings;
+		varTable[DetAttribute::SabreRing2] = &m_event.sabreArray[2].rings;
+		varTable[DetAttribute::SabreRing3] = &m_event.sabreArray[3].rings;
+		varTable[DetAttribute::SabreRing4] = &m_event.sabreArray[4].rings;
+		varTable[DetAttribute::SabreWedge0] = &m_event.sabreArray[0].wedges;
+		varTable[DetAttribute::SabreWedge1] = &m_event.sabreArray[1].wedges;
+		varTable[DetAttribute::SabreWedge2] = &m_event.sabreArray[2].wedges;
+		varTable[DetAttribute::SabreWedge3] = &m_event.sabreArray[3].wedges;
+		varTable[DetAttribute::SabreWedge4] = &m_event.sabreArray[4].wedges;
 	*/
 		/*For focal plane: Only one focal plane, so each variable is uniquely
 		  identified by its attribute
 		*/
 
-		varMap[DetAttribute::CEBRA0] = &m_event.cebraArray[0].cebr;
-		varMap[DetAttribute::CEBRA1] = &m_event.cebraArray[1].cebr;
-		varMap[DetAttribute::CEBRA2] = &m_event.cebraArray[2].cebr;
-		varMap[DetAttribute::CEBRA3] = &m_event.cebraArray[3].cebr;
-		varMap[DetAttribute::CEBRA4] = &m_event.cebraArray[4].cebr;
+		varTable[DetAttribute::CEBRA0] = &m_event.cebraArray[0].cebr;
+		varTable[DetAttribute::CEBRA1] = &m_event.cebraArray[1].cebr;
+		varTable[DetAttribute::CEBRA2] = &m_event.cebraArray[2].cebr;
+		varTable[DetAttribute::CEBRA3] = &m_event.cebraArray[3].cebr;
+		varTable[DetAttribute::CEBRA4] = &m_event.cebraArray[4].cebr;
 
 
-		varMap[DetAttribute::ScintLeft] = &m_event.focalPlane.scintL;
-		varMap[DetAttribute::ScintRight] = &m_event.focalPlane.scintR;
-		varMap[DetAttribute::Cathode] = &m_event.focalPlane.cathode;
-		varMap[DetAttribute::DelayFR] = &m_event.focalPlane.delayFR;
-		varMap[DetAttribute::DelayFL] = &m_event.focalPlane.delayFL;
-		varMap[DetAttribute::DelayBL] = &m_event.focalPlane.delayBL;
-		varMap[DetAttribute::DelayBR] = &m_event.focalPlane.delayBR;
-		varMap[DetAttribute::AnodeFront] = &m_event.focalPlane.anodeF;
-		varMap[DetAttribute::AnodeBack] = &m_event.focalPlane.anodeB;
-		varMap[DetAttribute::Monitor] = &m_event.focalPlane.monitor;
+		varTable[DetAttribute::ScintLeft] = &m_event.focalPlane.scintL;
+		varTable[DetAttribute::ScintRight] = &m_event.focalPlane.scintR;
+		varTable[DetAttribute::Cathode] = &m_event.focalPlane.cathode;
+		varTable[DetAttribute::DelayFR] = &m_event.focalPlane.delayFR;
+		varTable[DetAttribute::DelayFL] = &m_event.focalPlane.delayFL;
+		varTable[DetAttribute::DelayBL] = &m_event.focalPlane.delayBL;
+		varTable[DetAttribute::DelayBR] = &m_event.focalPlane.delayBR;
+		varTable[DetAttribute::AnodeFront] = &m_event.focalPlane.anodeF;
+		varTable[DetAttribute::AnodeBack] = &m_event.focalPlane.anodeB;
+		varTable[DetAttribute::Monitor] = &m_event.focalPlane.monitor;
 	
 	}
 	
-	/*Reset output structure to blank*/
+	/*Reset output structure to blank, keeping the memory of its hit vectors for the next event*/
 	void SlowSort::Reset() 
 	{
-		m_event = m_blank;
+		ClearHits(m_event);
 	}
 	
-	bool SlowSort::AddHitToEvent(CompassHit& mhit) 
+	/*
+		Build events around a trigger: only a hit of the trigger attribute (i.e. ScintLeft) opens an event, which
+		then holds the hits within lookback before the trigger and within the coincidence window after it. Hits
+		that are in no such window never make an event. NoneAttr returns to opening an event at any hit.
+	*/
+	void SlowSort::SetTrigger(DetAttribute trigger, double lookback)
+	{
+		m_trigger = trigger;
+		m_lookback = ToPicoseconds(lookback);
+		m_lookbackHits.clear();
+	}
+	
+	/*
+		Add the hits of a batch from index first on, stopping after the hit that completes an event (IsEventReady()).
+		Returns the index of the next hit to add; hits.size() once the whole batch has been added.
+	*/
+	std::size_t SlowSort::AddHitsToEvent(const HitBatch& hits, std::size_t first)
+	{
+		std::size_t index = first;
+		while(index < hits.size())
+		{
+			AddHitToEvent(hits, index++);
+			if(m_eventFlag)
+				break;
+		}
+		return index;
+	}
+	
+	bool SlowSort::AddHitToEvent(const HitBatch& hits, std::size_t index) 
 	{
 		DPPChannel curHit;
-		curHit.Timestamp = mhit.timestamp;
-		curHit.Energy = mhit.energy;
-		curHit.EnergyShort = mhit.energyShort;
-		curHit.Channel = mhit.channel;
-		curHit.Board = mhit.board;
-		curHit.Flags = mhit.flags;
+		curHit.Timestamp = hits.timestamp[index];
+		curHit.Energy = hits.energy[index];
+		curHit.EnergyShort = hits.energyShort[index];
+		curHit.Channel = hits.channel[index];
+		curHit.Board = hits.board[index];
+		curHit.Flags = hits.flags[index];
+
+		//Hits out of time order are dropped on both paths
+		if(curHit.Timestamp < previousHitTime)
+		{
+			m_droppedHits++;
+			return false;
+		}
+		previousHitTime = curHit.Timestamp;
+
+		if(m_trigger != DetAttribute::NoneAttr)
+			return AddHitToTriggeredEvent(curHit);
 	
 		if(m_hitList.empty()) 
 		{
 			startTime = curHit.Timestamp;
 			m_hitList.push_back(curHit);
 		} 
-		else if (curHit.Timestamp < previousHitTime)
-			return false;
-		else if ((curHit.Timestamp - startTime) < m_coincWindow)
+		else if (curHit.Timestamp < startTime + m_coincWindow) //integer ps; written so that an early hit can't wrap around
 			m_hitList.push_back(curHit);
 		else 
 		{
@@ -114,8 +173,50 @@ namespace EventBuilder {
 		return true;
 	}
 	
+	bool SlowSort::AddHitToTriggeredEvent(const DPPChannel& curHit)
+	{
+		if(!m_hitList.empty())
+		{
+			if(curHit.Timestamp < startTime + m_coincWindow)
+			{
+				m_hitList.push_back(curHit);
+				return true;
+			}
+			ProcessEvent();
+			m_hitList.clear();
+			m_eventFlag = true;
+		}
+	
+		if(IsTrigger(curHit))
+		{
+			startTime = curHit.Timestamp;
+			for(auto& prevHit : m_lookbackHits)
+			{
+				if(prevHit.Timestamp + m_lookback > startTime)
+					m_hitList.push_back(prevHit);
+			}
+			m_lookbackHits.clear();
+			m_hitList.push_back(curHit);
+		}
+		else if(m_lookback > 0)
+		{
+			while(!m_lookbackHits.empty() && m_lookbackHits.front().Timestamp + m_lookback <= curHit.Timestamp)
+				m_lookbackHits.pop_front();
+			m_lookbackHits.push_back(curHit);
+		}
+	
+		return true;
+	}
+	
+	bool SlowSort::IsTrigger(const DPPChannel& curHit)
+	{
+		const ChannelRoute& route = m_channels.GetRoute(curHit.Channel + curHit.Board*16);
+		return route.mapped && route.attribute == m_trigger;
+	}
+	
 	void SlowSort::FlushHitsToEvent()
 	{
+		m_lookbackHits.clear();
 		if(m_hitList.empty())
 		{
 			m_eventFlag = false;
@@ -146,43 +247,44 @@ namespace EventBuilder {
 		{
 			gchan = curHit.Channel + curHit.Board*16; //global channel
 			event_stats->Fill(gchan, size);
+			dhit.Timestamp = curHit.Timestamp;
 			dhit.Time = curHit.Timestamp/1.0e3;
 			dhit.Ch = gchan;
 			dhit.Long = curHit.Energy;
 			dhit.Short = curHit.EnergyShort;
-			auto channel_info = cmap.FindChannel(gchan);
+			const ChannelRoute& route = m_channels.GetRoute(gchan);
 	
-			if(channel_info == cmap.End())
+			if(!route.mapped)
 			{
 				EVB_WARN("At SlowSort::ProcessEvent() -- Data Assignment Error! Global channel {0} found but not assigned in ChannelMap! Skipping data.",gchan);
 				continue;
 			}
 			  
-			if(channel_info->second.type == DetType::FocalPlane)
+			if(route.type == DetType::FocalPlane)
 			{
-			  auto variable = varMap.find(channel_info->second.attribute);
-			  if(variable !=  varMap.end())
-			    variable->second->push_back(dhit);
+			  std::vector<DetectorHit>* variable = varTable[route.attribute];
+			  if(variable != nullptr)
+			    variable->push_back(dhit);
 			} 
 			/*
-			else if(channel_info->second.type == DetType::Sabre)
+			else if(route.type == DetType::Sabre)
 			{
-				auto variable = varMap.find(channel_info->second.attribute);
-				if(variable != varMap.end())
-					variable->second->push_back(dhit);
+				std::vector<DetectorHit>* variable = varTable[route.attribute];
+				if(variable != nullptr)
+					variable->push_back(dhit);
 			}
 			*/
 
-			else if(channel_info->second.type == DetType::CEBRA)
+			else if(route.type == DetType::CEBRA)
 			{
-				auto variable = varMap.find(channel_info->second.attribute);
-				if(variable != varMap.end())
-					variable->second->push_back(dhit);
+				std::vector<DetectorHit>* variable = varTable[route.attribute];
+				if(variable != nullptr)
+					variable->push_back(dhit);
 			}
 			else 
 			{
 				EVB_WARN("At SlowSort::ProcessEvent() -- Data Assignment Error! Channel ({0}, {1}, {2}) exists in ChannelMap, but does not have an assigned variable! Skipping data.",
-						gchan, channel_info->second.type, channel_info->second.attribute);
+						gchan, route.type, route.attribute);
 			}
 		}
 		//Organize the SABRE data in descending energy order
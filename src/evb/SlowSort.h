@@ -10,11 +10,13 @@
 #ifndef SLOW_SORT_H
 #define SLOW_SORT_H
 
-#include "CompassHit.h"
+#include "HitBatch.h"
 #include "DataStructs.h"
 #include "ChannelMap.h"
+#include "ChannelTable.h"
 #include <TH2.h>
-#include <unordered_map>
+#include <array>
+#include <deque>
 
 namespace EventBuilder {
 
@@ -24,32 +26,43 @@ namespace EventBuilder {
 	public:
 		SlowSort();
 		SlowSort(double windowSize, const std::string& mapfile);
+		SlowSort(double windowSize, const ChannelTable& channels);
 		~SlowSort();
-		inline void SetWindowSize(double window) { m_coincWindow = window; }
-		inline bool SetMapFile(const std::string& mapfile) { return cmap.FillMap(mapfile); }
-		bool AddHitToEvent(CompassHit& mhit);
+		inline void SetWindowSize(double window) { m_coincWindow = ToPicoseconds(window); }
+		bool SetMapFile(const std::string& mapfile);
+		void SetTrigger(DetAttribute trigger, double lookback);
+		bool AddHitToEvent(const HitBatch& hits, std::size_t index);
+		std::size_t AddHitsToEvent(const HitBatch& hits, std::size_t first);
 		const CoincEvent& GetEvent();
 		inline TH2F* GetEventStats() { return event_stats; }
 		void FlushHitsToEvent(); //For use with *last* hit list
 		inline bool IsEventReady() { return m_eventFlag; }
+		inline uint64_t GetDroppedHits() const { return m_droppedHits; } //hits earlier than the hit before them
 	
 	private:
 		void InitVariableMaps();
 		void Reset();
 		void ProcessEvent();
+		bool AddHitToTriggeredEvent(const DPPChannel& curHit);
+		bool IsTrigger(const DPPChannel& curHit);
 	
-		double m_coincWindow;
+		uint64_t m_coincWindow; //ps
 		std::vector<DPPChannel> m_hitList;
 		bool m_eventFlag;
-		CoincEvent m_event;
-		CoincEvent m_blank;
+		CoincEvent m_event; //refilled in place for every event
 		
-		double startTime, previousHitTime;    
-		std::unordered_map<DetAttribute, std::vector<DetectorHit>*> varMap;
+		uint64_t startTime, previousHitTime; //ps
+		uint64_t m_droppedHits;
+		std::array<std::vector<DetectorHit>*, DetAttribute::NoneAttr + 1> varTable = {}; //destination of each attribute, null for none
+
+		DetAttribute m_trigger = DetAttribute::NoneAttr; //only hits of this attribute open events; NoneAttr for any hit
+		uint64_t m_lookback = 0; //hits up to this long (ps) before a trigger are added to its event
+		std::deque<DPPChannel> m_lookbackHits; //hits since the last event that are within the lookback of the latest hit
 	
 		TH2F* event_stats;
 	
 		ChannelMap cmap;
+		ChannelTable m_channels; //routes global channels to attributes
 	 
 	};
 
@@ -0,0 +1,125 @@
+/*
+	TimeSlicer.cpp
+	Cuts a run into time slices which can be event built independently. A cut is only ever placed at a hit which
+	trails the hit before it (across all files of the run) by at least the coincidence window. SlowSort opens a new
+	event at such a hit no matter what came before it, so building each slice on its own gives exactly the events
+	of the serial build. Cut targets are spread evenly in time, and each cut is moved forward to the first gap
+	at or after its target. Slices are given as the index of the first hit of the slice in each file, so every
+	file must be time ordered and have fixed size records.
+*/
+#include "EventBuilder.h"
+#include "TimeSlicer.h"
+#include "HitMerger.h"
+
+namespace EventBuilder {
+
+	TimeSlicer::TimeSlicer(double window) :
+		m_window(ToPicoseconds(window))
+	{
+	}
+
+	TimeSlicer::~TimeSlicer() {}
+
+	std::vector<std::vector<uint64_t>> TimeSlicer::FindSlices(std::vector<CompassFile>& files, int nslices)
+	{
+		std::vector<uint64_t> nhits;
+		uint64_t tmin = std::numeric_limits<uint64_t>::max(), tmax = 0;
+		for(auto& file : files)
+		{
+			nhits.push_back(file.GetNumberOfHits());
+			if(nhits.back() == 0)
+				continue;
+			tmin = std::min(tmin, file.ReadTimestamp(0));
+			tmax = std::max(tmax, file.ReadTimestamp(nhits.back() - 1));
+		}
+
+		std::vector<std::vector<uint64_t>> bounds;
+		bounds.emplace_back(files.size(), 0);
+		if(tmin >= tmax)
+		{
+			bounds.push_back(nhits);
+			return bounds;
+		}
+
+		uint64_t lastCut = tmin;
+		for(int k=1; k<nslices; k++)
+		{
+			uint64_t target = tmin + uint64_t(double(tmax - tmin) * k / nslices);
+			uint64_t cut;
+			if(target <= lastCut || !FindGap(files, nhits, target, cut) || cut <= lastCut)
+				continue;
+
+			std::vector<uint64_t> first;
+			for(std::size_t i=0; i<files.size(); i++)
+				first.push_back(LowerBound(files[i], nhits[i], cut));
+			bounds.push_back(first);
+			lastCut = cut;
+		}
+		bounds.push_back(nhits);
+
+		return bounds;
+	}
+
+	/*Index of the first hit at or after time (nhits if there is none)*/
+	uint64_t TimeSlicer::LowerBound(CompassFile& file, uint64_t nhits, uint64_t time)
+	{
+		uint64_t low = 0, high = nhits;
+		while(low < high)
+		{
+			uint64_t mid = low + (high - low)/2;
+			if(file.ReadTimestamp(mid) < time)
+				low = mid + 1;
+			else
+				high = mid;
+		}
+		return low;
+	}
+
+	/*
+		Merge the run forward from target until a hit trails its predecessor by at least the window. The predecessor
+		of the first merged hit is the latest hit before target in any file. The gap is taken in integer ps, as
+		SlowSort does.
+	*/
+	bool TimeSlicer::FindGap(std::vector<CompassFile>& files, const std::vector<uint64_t>& nhits, uint64_t target, uint64_t& cutTime)
+	{
+		bool havePrevious = false;
+		uint64_t previous = 0;
+		for(std::size_t i=0; i<files.size(); i++)
+		{
+			uint64_t first = LowerBound(files[i], nhits[i], target);
+			if(first > 0)
+			{
+				uint64_t time = files[i].ReadTimestamp(first - 1);
+				if(!havePrevious || time > previous)
+					previous = time;
+				havePrevious = true;
+			}
+			files[i].SetBufferSize(s_scanBufferHits);
+			files[i].SetHitRange(first, nhits[i]);
+		}
+
+		HitMerger merger;
+		merger.Init(files);
+		HitBatch hits;
+		uint64_t nscanned = 0;
+		while(nscanned < s_maxScanHits && merger.GetNextHits(hits, s_scanBufferHits) > 0)
+		{
+			for(std::size_t i=0; i<hits.size() && nscanned < s_maxScanHits; i++)
+			{
+				uint64_t time = hits.timestamp[i];
+				if(havePrevious && time >= previous + m_window)
+				{
+					cutTime = time;
+					return true;
+				}
+				previous = time;
+				havePrevious = true;
+				nscanned++;
+			}
+			hits.clear();
+		}
+
+		return false;
+	}
+
+}
@@ -0,0 +1,39 @@
+/*
+	TimeSlicer.h
+	Cuts a run into time slices which can be event built independently. A cut is only ever placed at a hit which
+	trails the hit before it (across all files of the run) by at least the coincidence window. SlowSort opens a new
+	event at such a hit no matter what came before it, so building each slice on its own gives exactly the events
+	of the serial build. Cut targets are spread evenly in time, and each cut is moved forward to the first gap
+	at or after its target. Slices are given as the index of the first hit of the slice in each file, so every
+	file must be time ordered and have fixed size records.
+*/
+#ifndef TIMESLICER_H
+#define TIMESLICER_H
+
+#include "CompassFile.h"
+
+namespace EventBuilder {
+
+	class TimeSlicer
+	{
+	public:
+		TimeSlicer(double window);
+		~TimeSlicer();
+		/*
+			Returns nslices+1 (or fewer, if gaps can't be found) rows of first hit indices per file; slice k covers
+			[bounds[k][f], bounds[k+1][f]) of file f. The files are left positioned anywhere; restart them with SetHitRange.
+		*/
+		std::vector<std::vector<uint64_t>> FindSlices(std::vector<CompassFile>& files, int nslices);
+
+	private:
+		uint64_t LowerBound(CompassFile& file, uint64_t nhits, uint64_t time);
+		bool FindGap(std::vector<CompassFile>& files, const std::vector<uint64_t>& nhits, uint64_t target, uint64_t& cutTime);
+
+		uint64_t m_window; //ps
+		static constexpr uint64_t s_maxScanHits = 1000000; //give up on a cut if no gap turns up in this many hits
+		static constexpr int s_scanBufferHits = 4096;
+	};
+
+}
+
+#endif
@@ -199,6 +199,7 @@ EVBMainFrame::EVBMainFrame(const TGWindow* p, UInt_t w, UInt_t h) :
 	fTypeBox->AddEntry("Convert Fast", EventBuilder::EVBApp::Operation::ConvertFast);
 	fTypeBox->AddEntry("Convert SlowA", EventBuilder::EVBApp::Operation::ConvertSlowA);
 	fTypeBox->AddEntry("Convert FastA", EventBuilder::EVBApp::Operation::ConvertFastA);
+	fTypeBox->AddEntry("Convert Multi", EventBuilder::EVBApp::Operation::ConvertMulti);
 	fTypeBox->AddEntry("Convert", EventBuilder::EVBApp::Operation::Convert);
 	fTypeBox->AddEntry("Merge ROOT", EventBuilder::EVBApp::Operation::Merge);
 	fTypeBox->AddEntry("Plot", EventBuilder::EVBApp::Operation::Plot);
@@ -377,6 +378,11 @@ void EVBMainFrame::DoRun()
 			fBuilder.Convert2FastAnalyzedRoot();
 			break;
 		}
+		case EventBuilder::EVBApp::Operation::ConvertMulti :
+		{
+			fBuilder.Convert2MultiRoot();
+			break;
+		}
 	}
 
 	EnableAllInput();
@@ -7,9 +7,9 @@ int main(int argc, char** argv)
 {
 	EnforceDictionaryLinked();
 	EventBuilder::Logger::Init();
-	if(argc != 3) 
+	if(argc != 3 && argc != 4) 
 	{
-		EVB_ERROR("Incorrcect number of commandline arguments! Need to specify type of operation and input file.");
+		EVB_ERROR("Incorrcect number of commandline arguments! Need to specify type of operation and input file, and optionally the number of jobs.");
 		return 1;
 	}
 
@@ -23,6 +23,7 @@ int main(int argc, char** argv)
 		ConvertFast (convert binary archive to event fast data)
 		ConvertSlowA (convert binary archive to analyzed slow event data)
 		ConvertFastA (convert binary archive to analyzed fast event data)
+		ConvertMulti (convert binary archive to several of the above in one pass, see MultiOutputs)
 		Merge (combine root files)
 		Plot (generate a default histogram file from analyzed data)
 	*/
@@ -30,6 +31,8 @@ int main(int argc, char** argv)
 	EventBuilder::EVBApp theBuilder;
 
 	theBuilder.ReadConfigFile(filename);
+	if(argc == 4)
+		theBuilder.SetJobs(std::atoi(argv[3])); //overrides the input file
 
 	EventBuilder::Stopwatch timer;
 	timer.Start();
@@ -47,6 +50,8 @@ int main(int argc, char** argv)
 		theBuilder.Convert2SlowAnalyzedRoot();
 	else if (operation == "ConvertFastA")
 		theBuilder.Convert2FastAnalyzedRoot();
+	else if (operation == "ConvertMulti")
+		theBuilder.Convert2MultiRoot();
 	else 
 	{
 		EVB_ERROR("Invalid operation {0} given to EventBuilder! Exiting.", operation);
@@ -5,4 +5,30 @@
   are linked when compiled as shared libraries (the recommended method). As a work around, as a dummy function that 
   ensures the library is linked (better than no-as-needed which I dont think is in general supported across platforms)
 */
-bool EnforceDictionaryLinked() { return true; }
\ No newline at end of file
+bool EnforceDictionaryLinked() { return true; }
+
+void ClearHits(CeBrADetector& detector)
+{
+  detector.cebr.clear();
+}
+
+void ClearHits(FPDetector& detector)
+{
+  detector.delayFL.clear();
+  detector.delayFR.clear();
+  detector.delayBL.clear();
+  detector.delayBR.clear();
+  detector.anodeF.clear();
+  detector.anodeB.clear();
+  detector.scintL.clear();
+  detector.scintR.clear();
+  detector.cathode.clear();
+  detector.monitor.clear();
+}
+
+void ClearHits(CoincEvent& event)
+{
+  ClearHits(event.focalPlane);
+  for(auto& detector : event.cebraArray)
+    ClearHits(detector);
+}
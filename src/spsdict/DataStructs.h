@@ -7,18 +7,20 @@
 #define DATA_STRUCTS_H
 
 #include <vector>
+#include <cstdint>
 
 struct DPPChannel 
 {
-  double Timestamp;
+  uint64_t Timestamp; //ps
   int Channel, Board, Energy, EnergyShort;
   int Flags;
 };
 
 struct DetectorHit 
 {
-  double Long=-1, Short=-1, Time=-1;
+  double Long=-1, Short=-1, Time=-1; //Time in ns, for analysis; windows and differences use Timestamp
   int Ch=-1;
+  uint64_t Timestamp=0; //ps
 };
 
 struct CeBrADetector 
@@ -106,6 +108,15 @@ struct ProcessedEvent
   CeBrADetector cebraArray[5];
 };
 
+/*
+  Empty every hit vector of a structure, keeping the memory the vectors already hold. Structures that are
+  refilled for each event are cleared this way, so that after the first few events building an event no
+  longer allocates.
+*/
+void ClearHits(CeBrADetector& detector);
+void ClearHits(FPDetector& detector);
+void ClearHits(CoincEvent& event);
+
 /*
   ROOT does a bad job of ensuring that header-only type dictionaries (the only type they explicity accept)
   are linked when compiled as shared libraries (the recommended method). As a work around, as a dummy function that 